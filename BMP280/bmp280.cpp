@@ -3,22 +3,149 @@
 // Constructor
 // The i2c address is 0x76 if the 'SDO' pin is connected to GND (ground)
 // Refer to Chapter 5.2 and 6 of the datasheet for more information
-bmp280::bmp280(hwlib::i2c_bus & bus, uint8_t i2c_address ) : bus(bus), i2c_address(i2c_address) {
-    loadCalibration();
+// The bus is not used here, see requireCalibration() and requireShadows()
+bmp280::bmp280(hwlib::i2c_bus & bus, uint8_t i2c_address ) :
+    i2c_transport(bus, i2c_address), transport(i2c_transport), ctrl_meas_shadow(0), config_shadow(0), ctrl_hum_shadow(SAMPLING_X1),
+    chip_id(0), humidity_calibration(), chip_detected(false), calibration_loaded(false), shadows_loaded(false), measurement_pending(false), measurement_ready_us(0)
+{}
+
+bmp280::bmp280(hwlib::i2c_bus & bus, const bmp280_calibration_blob& calibration, uint8_t i2c_address ) :
+    bmp280(bus, i2c_address)
+{
+    setCalibration(calibration);
 }
 
-/**
-*   The following two methods were written by Bas van den Bergh, a Computer Engineering student at HU.
-*   Source: https://github.com/BasvandenBergh/IPASS_jaar1_BAS
-**/
-void bmp280::write(uint8_t data) {
-    hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(i2c_address);
-    wtrans.write(data);
-} 
+bmp280::bmp280(bmp280_transport & transport) :
+    i2c_transport(), transport(transport), ctrl_meas_shadow(0), config_shadow(0), ctrl_hum_shadow(SAMPLING_X1),
+    chip_id(0), humidity_calibration(), chip_detected(false), calibration_loaded(false), shadows_loaded(false), measurement_pending(false), measurement_ready_us(0)
+{}
+
+bmp280::bmp280(bmp280_transport & transport, const bmp280_calibration_blob& calibration) :
+    bmp280(transport)
+{
+    setCalibration(calibration);
+}
+
+void bmp280::initialize() {
+    requireChip();
+    requireCalibration();
+    requireShadows();
+}
+
+bool bmp280::setCalibration(const bmp280_calibration_blob& calibration) {
+    if (!deserializeCalibration(calibration, calibration_data)) {
+        return false;
+    }
+    buildCompensationPlan(calibration_data, compensation_plan);
+    calibration_loaded = true;
+    return true;
+}
+
+bmp280_calibration_blob bmp280::getCalibrationBlob() {
+    requireCalibration();
+    bmp280_calibration_blob blob;
+    serializeCalibration(calibration_data, blob);
+    return blob;
+}
+
+void bmp280::requireCalibration() {
+    if (!calibration_loaded) {
+        loadCalibration();
+        calibration_loaded = true;
+    }
+}
+
+// Fills the shadow copies of ctrl_meas and config (0xF4..0xF5) in one burst, so setters don't have to read them.
+// The chip is detected first, so ctrl_hum of a BME280 is set before a setter writes ctrl_meas and latches it.
+void bmp280::requireShadows() {
+    if (shadows_loaded) {
+        return;
+    }
+    requireChip();
+    uint8_t registers[2];
+    readRegisters(BMP280_CTRL_REG, registers, 2);
+    ctrl_meas_shadow = registers[0];
+    config_shadow = registers[1];
+    shadows_loaded = true;
+}
+
+// Reads the chip ID (0xD0) and on a BME280 the humidity calibration (0xA1 and 0xE1..0xE7), once
+void bmp280::requireChip() {
+    if (chip_detected) {
+        return;
+    }
+    readRegisters(BMP280_CHIP_ID_REG, &chip_id, 1);
+    chip_detected = true;
+    if (chip_id != BME280_CHIP_ID) {
+        return;
+    }
+
+    uint8_t h1;
+    uint8_t registers[BME280_HUMIDITY_CALIBRATION_LENGTH];
+    readRegisters(BME280_DIG_H1_REG, &h1, 1);
+    readRegisters(BME280_DIG_H2_REG, registers, BME280_HUMIDITY_CALIBRATION_LENGTH);
+    decodeHumidityCalibration(h1, registers, humidity_calibration);
+
+    // Humidity is skipped after a reset, Chapter 5.4.3 of the BME280 datasheet
+    const uint8_t ctrl_hum[] = {BME280_CTRL_HUM_REG, ctrl_hum_shadow};
+    writeRegisters(ctrl_hum, sizeof(ctrl_hum));
+}
+
+uint8_t bmp280::getChipId() {
+    requireChip();
+    return chip_id;
+}
 
-void bmp280::read(uint8_t *data, int data_size){
-    hwlib::i2c_read_transaction rtrans = ((hwlib::i2c_bus*)(&bus))->read(i2c_address);
-    rtrans.read(data, data_size);
+bool bmp280::hasHumidity() {
+    requireChip();
+    return chip_id == BME280_CHIP_ID;
+}
+
+// ctrl_hum only takes effect with the next write to ctrl_meas, so ctrl_meas is written again in the same burst
+void bmp280::setHumidityOversampling(sampling_config osrs_h) {
+    if (!hasHumidity()) {
+        return;
+    }
+    requireShadows();
+    ctrl_hum_shadow = osrs_h;
+    const uint8_t registers[] = {BME280_CTRL_HUM_REG, ctrl_hum_shadow, BMP280_CTRL_REG, ctrl_meas_shadow};
+    writeRegisters(registers, sizeof(registers));
+}
+
+// All register access goes through these two methods, so the instrumentation sees every burst
+void bmp280::readRegisters(uint8_t reg, uint8_t* data, int data_size) {
+    BMP280_MEASURE_BUS();
+    BMP280_COUNT_TRANSACTION(data_size + 1);
+    transport.readRegisters(reg, data, data_size);
+}
+
+// Writes register address and value pairs in one burst, see Chapter 5.2.1 and 5.3.1 of the datasheet
+void bmp280::writeRegisters(const uint8_t* data, int data_size) {
+    BMP280_MEASURE_BUS();
+    BMP280_COUNT_TRANSACTION(data_size);
+    transport.writeRegisters(data, data_size);
+}
+
+void bmp280::writeConfiguration(uint8_t ctrl_meas, uint8_t config) {
+    // This is the first write of bmp280_static::setup() and configure(), ctrl_hum must be set before it
+    requireChip();
+
+    // Writes to config may be ignored in normal mode (Chapter 3.6.3), so the sensor is put to sleep first
+    const uint8_t registers[] = {
+        BMP280_CTRL_REG, static_cast<uint8_t>(ctrl_meas & ~0b11),
+        BMP280_CONFIG_REG, config,
+        BMP280_CTRL_REG, ctrl_meas
+    };
+    writeRegisters(registers, sizeof(registers));
+
+    // The sensor returns to sleep mode by itself after a forced conversion (Chapter 3.6.2),
+    // so the shadow copy doesn't keep the forced mode around to trigger a conversion on the next write
+    if ((ctrl_meas & 0b11) == FORCED_MODE) {
+        ctrl_meas &= ~(0b11);
+    }
+    ctrl_meas_shadow = ctrl_meas;
+    config_shadow = config;
+    shadows_loaded = true;
 }
 
 /* I was not able to get the following methods to work correctly.
@@ -47,38 +174,30 @@ void bmp280::loadCalibration() {
 
 // Read 8 bits from a register
 uint8_t bmp280::read8 ( uint8_t reg ) {
-    bus.write(i2c_address).write(reg);
     uint8_t result;
-    bus.read(i2c_address).read(&result, 1);
+    readRegisters(reg, &result, 1);
     return result;
 }
 
 // Read 16 bits and return them as a signed 16 bit integer
 int16_t bmp280::read16s( uint8_t reg ){
-  bus.write( i2c_address ).write( reg );
-  auto transaction = bus.read( i2c_address );
-  auto byte1 = transaction.read_byte();
-  auto byte2 = transaction.read_byte();
-  return static_cast<int16_t>((byte1 << 8) | byte2);
+    return static_cast<int16_t>(read16u(reg));
 }
 
 // Read 16 bits and return them as an unsigned 16 bit integer
 uint16_t bmp280::read16u( uint8_t reg ){
-  bus.write( i2c_address ).write( reg );
-  auto transaction = bus.read( i2c_address );
-  auto byte1 = transaction.read_byte();
-  auto byte2 = transaction.read_byte();
-  return static_cast<uint16_t>((byte1 << 8) | byte2);
+    uint8_t data[2];
+    readRegisters(reg, data, 2);
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
 }
 
 uint32_t bmp280::read20u(uint8_t reg) {
-    // Read the MSB and LSB from the register
-    uint32_t msb = read16u(reg);
-    uint32_t lsb = read8(reg + 2);
+    // Read the MSB, LSB and XLSB in one burst
+    uint8_t data[3];
+    readRegisters(reg, data, 3);
 
-    // Combine MSB and the top 4 bits of LSB to form the raw 20-bit data
-    uint32_t raw = (msb << 4) | (lsb >> 4);
-    return raw;
+    // Combine MSB, LSB and the top 4 bits of XLSB to form the raw 20-bit data
+    return (static_cast<uint32_t>(data[0]) << 12) | (static_cast<uint32_t>(data[1]) << 4) | (data[2] >> 4);
 }
 
 // This configuration is for a weather monitoring system. See Chapter 3.4 for other use cases.
@@ -94,72 +213,190 @@ void bmp280::setup() {
     setFilter(FILTER_OFF);
 }
 
-/**
-*   The following three methods were written by Bas van den Bergh, a Computer Engineering student at HU.
-*   Source: https://github.com/BasvandenBergh/IPASS_jaar1_BAS
-* 
-*   The algorithms for calculating the actual temp and pressure were created by Bosch and implemented by wovo.
-**/
+// Uses the oversampling settings from the shadow copy of the control register
+uint32_t bmp280::measurementTime() {
+    requireShadows();
+    sampling_config osrs_t = static_cast<sampling_config>((ctrl_meas_shadow >> 5) & 0b111);
+    sampling_config osrs_p = static_cast<sampling_config>((ctrl_meas_shadow >> 2) & 0b111);
+    sampling_config osrs_h = hasHumidity() ? static_cast<sampling_config>(ctrl_hum_shadow) : SAMPLING_NONE;
+    return measurementTimeUs(osrs_t, osrs_p, osrs_h);
+}
 
-// Compensates the raw temperature reading
-double bmp280::getTemperature() {
-    uint32_t raw_temp = readTemperatureRaw();
+// Triggers a single conversion in forced mode, see Chapter 3.6.2 of the datasheet
+void bmp280::startMeasurement() {
+    requireShadows();
+    const uint8_t registers[] = {BMP280_CTRL_REG, static_cast<uint8_t>((ctrl_meas_shadow & ~(0b11)) | FORCED_MODE)};
+    writeRegisters(registers, sizeof(registers));
 
-    double var1, var2, T;
-    var1 = (((double)raw_temp) / 16384.0 - ((double)calibration_data.dig_T1) / 1024.0) * ((double)calibration_data.dig_T2);
-    var2 = ((((double)raw_temp) / 131072.0 - ((double)calibration_data.dig_T1) / 8192.0) * (((double)raw_temp) / 131072.0 - ((double)calibration_data.dig_T1) / 8192.0)) * ((double)calibration_data.dig_T3);
-    calibration_data.t_fine = (int32_t)(var1 + var2);
-    T = (var1 + var2) / 5120.0;
-    return T;
+    measurement_ready_us = hwlib::now_us() + measurementTime();
+    measurement_pending = true;
 }
 
-// Compensates the raw pressure reading
-double bmp280::getPressure() {
-    uint32_t raw_press = readPressureRaw();
-
-    double var1, var2, p;
-    var1 = ((double)calibration_data.t_fine/2.0) - 64000.0;
-    var2 = var1 * var1 * ((double)calibration_data.dig_P6) / 32768.0;
-    var2 = var2 + var1 * ((double)calibration_data.dig_P5) * 2.0;
-    var2 = (var2/4.0) + (((double)calibration_data.dig_P4) * 65536.0);
-    var1 = (((double)calibration_data.dig_P3) * var1 * var1 / 524288.0 + ((double)calibration_data.dig_P2) * var1) / 524288.0;
-    var1 = (1.0 + var1 / 32768.0) * ((double)calibration_data.dig_P1);
-    if (var1 == 0) {
-        return 0;  // avoid exception caused by division by zero
+uint32_t bmp280::remainingMeasurementTime() {
+    uint_fast64_t now = hwlib::now_us();
+    if (!measurement_pending || now >= measurement_ready_us) {
+        return 0;
     }
-    p = 1048576.0 - (double)raw_press;
-    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
-    var1 = ((double)calibration_data.dig_P9) * p * p / 2147483648.0;
-    var2 = p * ((double)calibration_data.dig_P8) / 32768.0;
-    p = p + (var1 + var2 + ((double)calibration_data.dig_P7)) / 16.0;
-    return p;
+    return static_cast<uint32_t>(measurement_ready_us - now);
 }
 
-// Read and store calibration data
+bool bmp280::poll() {
+    if (!measurement_pending) {
+        return true;
+    }
+
+    // Don't use the bus before the conversion can possibly be done
+    if (hwlib::now_us() < measurement_ready_us) {
+        return false;
+    }
+
+    if (readStatus() & BMP280_STATUS_MEASURING) {
+        return false;
+    }
+
+    measurement_pending = false;
+    return true;
+}
+
+bmp280_sample bmp280::collect() {
+    measurement_pending = false;
+    return readSample();
+}
+
+bmp280_sample_int bmp280::collectInt() {
+    measurement_pending = false;
+    return readSampleInt();
+}
+
+// Compensates the raw temperature reading with the pre-scaled coefficients
+double bmp280::getTemperature() {
+    requireCalibration();
+    BMP280_MEASURE_TIME(temperature);
+    uint32_t raw = readTemperatureRaw();
+    BMP280_MEASURE_TIME(compensation);
+    return compensateTemperature(compensation_plan, raw, calibration_data.t_fine);
+}
+
+// Compensates the raw pressure reading with the pre-scaled coefficients
+double bmp280::getPressure() {
+    requireCalibration();
+    BMP280_MEASURE_TIME(pressure);
+    uint32_t raw = readPressureRaw();
+    BMP280_MEASURE_TIME(compensation);
+    return compensatePressure(compensation_plan, raw, calibration_data.t_fine);
+}
+
+const bmp280_calibration_data& bmp280::getCalibrationData() {
+    requireCalibration();
+    return calibration_data;
+}
+
+// Reads the raw pressure and temperature of one conversion in a single burst (0xF7..0xFC)
+bmp280_raw_sample bmp280::readSampleRaw() {
+    uint8_t data[BMP280_DATA_LENGTH];
+    readRegisters(BMP280_PRESS_DATA_REG, data, BMP280_DATA_LENGTH);
+
+    // Each value is stored as msb, lsb and the top 4 bits of xlsb
+    bmp280_raw_sample raw;
+    raw.pressure = (static_cast<uint32_t>(data[0]) << 12) | (static_cast<uint32_t>(data[1]) << 4) | (data[2] >> 4);
+    raw.temperature = (static_cast<uint32_t>(data[3]) << 12) | (static_cast<uint32_t>(data[4]) << 4) | (data[5] >> 4);
+    return raw;
+}
+
+// Compensates the temperature first, so the pressure uses the t_fine of the same conversion
+bmp280_sample bmp280::readSample() {
+    requireCalibration();
+    bmp280_raw_sample raw = readSampleRaw();
+    BMP280_MEASURE_TIME(compensation);
+
+    bmp280_sample sample;
+    sample.temperature = compensateTemperature(compensation_plan, raw.temperature, calibration_data.t_fine);
+    sample.pressure = compensatePressure(compensation_plan, raw.pressure, calibration_data.t_fine);
+    return sample;
+}
+
+// Integer versions of the methods above, these need no floating point support
+int32_t bmp280::getTemperatureInt() {
+    requireCalibration();
+    BMP280_MEASURE_TIME(temperature);
+    uint32_t raw = readTemperatureRaw();
+    BMP280_MEASURE_TIME(compensation);
+    return compensateTemperatureInt(calibration_data, raw, calibration_data.t_fine);
+}
+
+uint32_t bmp280::getPressureInt() {
+    requireCalibration();
+    BMP280_MEASURE_TIME(pressure);
+    uint32_t raw = readPressureRaw();
+    BMP280_MEASURE_TIME(compensation);
+    return compensatePressureInt(calibration_data, raw, calibration_data.t_fine);
+}
+
+bmp280_sample_int bmp280::readSampleInt() {
+    requireCalibration();
+    bmp280_raw_sample raw = readSampleRaw();
+    BMP280_MEASURE_TIME(compensation);
+
+    bmp280_sample_int sample;
+    sample.temperature = compensateTemperatureInt(calibration_data, raw.temperature, calibration_data.t_fine);
+    sample.pressure = compensatePressureInt(calibration_data, raw.pressure, calibration_data.t_fine);
+    return sample;
+}
+
+// Reads 0xF7..0xFE in one burst on a BME280, the humidity is 16 bits without xlsb (Chapter 5.4.9 of the BME280 datasheet)
+bme280_sample_int bmp280::readHumiditySampleInt() {
+    requireCalibration();
+    bool humidity = hasHumidity();
+    uint8_t data[BME280_DATA_LENGTH];
+    readRegisters(BMP280_PRESS_DATA_REG, data, humidity ? BME280_DATA_LENGTH : BMP280_DATA_LENGTH);
+    BMP280_MEASURE_TIME(compensation);
+
+    uint32_t raw_press = (static_cast<uint32_t>(data[0]) << 12) | (static_cast<uint32_t>(data[1]) << 4) | (data[2] >> 4);
+    uint32_t raw_temp = (static_cast<uint32_t>(data[3]) << 12) | (static_cast<uint32_t>(data[4]) << 4) | (data[5] >> 4);
+
+    bme280_sample_int sample;
+    sample.temperature = compensateTemperatureInt(calibration_data, raw_temp, calibration_data.t_fine);
+    sample.pressure = compensatePressureInt(calibration_data, raw_press, calibration_data.t_fine);
+    // A skipped humidity would compensate to about 70 %RH, so it is reported as 0 like on a BMP280
+    uint32_t raw_hum = (static_cast<uint32_t>(data[6]) << 8) | data[7];
+    sample.humidity = humidity && raw_hum != BME280_RAW_HUMIDITY_SKIPPED
+        ? compensateHumidityInt(humidity_calibration, raw_hum, calibration_data.t_fine) : 0;
+    return sample;
+}
+
+bme280_sample_int bmp280::collectHumiditySampleInt() {
+    measurement_pending = false;
+    return readHumiditySampleInt();
+}
+
+/**
+*   The following method is based on a method written by Bas van den Bergh, a Computer Engineering student at HU.
+*   Source: https://github.com/BasvandenBergh/IPASS_jaar1_BAS
+**/
+
+// Read and store calibration data, all calibration registers are read in one burst
 void bmp280::loadCalibration() {
-    write(0x88);
-    read(digtemp, 6);
-    write(0x8E);
-    read(digpress, 18);
-    calibration_data.dig_T1 = digtemp[0] | (digtemp[1] << 8);
-    calibration_data.dig_T2 = (int16_t)(digtemp[2] | (digtemp[3] << 8));
-    calibration_data.dig_T3 = (int16_t)(digtemp[4] | (digtemp[5] << 8));
-    calibration_data.dig_P1 = digpress[0] | (digpress[1] << 8);
-    calibration_data.dig_P2 = (int16_t)(digpress[2] | (digpress[3] << 8));
-    calibration_data.dig_P3 = (int16_t)(digpress[4] | (digpress[5] << 8));
-    calibration_data.dig_P4 = (int16_t)(digpress[6] | (digpress[7] << 8));
-    calibration_data.dig_P5 = (int16_t)(digpress[8] | (digpress[9] << 8));
-    calibration_data.dig_P6 = (int16_t)(digpress[10] | (digpress[11] << 8));
-    calibration_data.dig_P7 = (int16_t)(digpress[12] | (digpress[13] << 8));
-    calibration_data.dig_P8 = (int16_t)(digpress[14] | (digpress[15] << 8));
-    calibration_data.dig_P9 = (int16_t)(digpress[16] | (digpress[17] << 8));
+    uint8_t registers[BMP280_CALIBRATION_LENGTH];
+    readRegisters(BMP280_DIG_T1_REG, registers, BMP280_CALIBRATION_LENGTH);
+    decodeCalibration(registers, calibration_data);
+    buildCompensationPlan(calibration_data, compensation_plan);
+
+    // Keep the old public buffers filled for existing users
+    for (int i = 0; i < 6; i++) {
+        digtemp[i] = registers[i];
+    }
+    for (int i = 0; i < 18; i++) {
+        digpress[i] = registers[6 + i];
+    }
 }
 
 // Set the power mode to the desired mode
 // See power_modes enum for available power modes.
 void bmp280::setPowerMode(power_modes mode) {
-    // Read the current value of the control register
-    uint8_t ctrl_meas = read8(BMP280_CTRL_REG);
+    requireShadows();
+
+    // Start from the shadow copy of the control register
+    uint8_t ctrl_meas = ctrl_meas_shadow;
 
     // Clear the mode bits (bit 1 and bit 0)
     ctrl_meas &= ~(0b11);
@@ -168,13 +405,14 @@ void bmp280::setPowerMode(power_modes mode) {
     ctrl_meas |= static_cast<uint8_t>(mode);
 
     // Write the updated value back to the control register
-    write(BMP280_CTRL_REG);
-    write(ctrl_meas);
+    writeConfiguration(ctrl_meas, config_shadow);
 }
 
 void bmp280::setOversampling(sampling_config osrs_t, sampling_config osrs_p) {
-    // Read the current value of the control register
-    uint8_t ctrl_meas = read8(BMP280_CTRL_REG);
+    requireShadows();
+
+    // Start from the shadow copy of the control register
+    uint8_t ctrl_meas = ctrl_meas_shadow;
 
     // Clear the osrs_t and osrs_p bits (bits 7:5 and 4:2)
     ctrl_meas &= ~(0b111 << 5);
@@ -185,13 +423,14 @@ void bmp280::setOversampling(sampling_config osrs_t, sampling_config osrs_p) {
     ctrl_meas |= static_cast<uint8_t>(osrs_p) << 2;
 
     // Write the updated value back to the control register
-    write(BMP280_CTRL_REG);
-    write(ctrl_meas);
+    writeConfiguration(ctrl_meas, config_shadow);
 }
 
 void bmp280::setFilter(filter_config filter) {
-    // Read the current value of the configuration register
-    uint8_t config = read8(BMP280_CONFIG_REG);
+    requireShadows();
+
+    // Start from the shadow copy of the configuration register
+    uint8_t config = config_shadow;
 
     // Clear the filter bits (bits 4:2)
     config &= ~(0b111 << 2);
@@ -200,15 +439,49 @@ void bmp280::setFilter(filter_config filter) {
     config |= static_cast<uint8_t>(filter) << 2;
 
     // Write the updated value back to the configuration register
-    write(BMP280_CONFIG_REG);
-    write(config);
+    writeConfiguration(ctrl_meas_shadow, config);
+}
+
+void bmp280::setStandby(standby_config standby) {
+    requireShadows();
+
+    // Start from the shadow copy of the configuration register
+    uint8_t config = config_shadow;
+
+    // Clear the standby bits (bits 7:5)
+    config &= ~(0b111 << 5);
+
+    // Set the new standby time
+    config |= static_cast<uint8_t>(standby) << 5;
+
+    // Write the updated value back to the configuration register
+    writeConfiguration(ctrl_meas_shadow, config);
+}
+
+bool bmp280::configure(const bmp280_tuning& tuning) {
+    if (!tuning.feasible) {
+        return false;
+    }
+    power_modes mode = tuning.mode == NORMAL_MODE ? NORMAL_MODE : SLEEP_MODE;
+    writeConfiguration(makeCtrlMeas(tuning.osrs_t, tuning.osrs_p, mode), makeConfig(tuning.standby, tuning.filter));
+    return true;
+}
+
+// See Chapter 3.6.3 of the datasheet for the timing of normal mode
+uint32_t bmp280::normalModePeriod() {
+    requireShadows();
+    standby_config standby = static_cast<standby_config>((config_shadow >> 5) & 0b111);
+    return measurementTime() + standbyTimeUs(standby, getChipId());
+}
+
+uint8_t bmp280::readStatus() {
+    return read8(BMP280_STATUS_REG);
 }
 
 // Reads the raw temperature data
 uint32_t bmp280::readTemperatureRaw() {
     int32_t totaaltemp = 0x00;
-    write(0xFA);
-    read(resultstemp, 3);
+    readRegisters(0xFA, resultstemp, 3);
     int32_t newresulttemp = resultstemp[2] >> 4;
     totaaltemp = resultstemp[0] << 8;
     totaaltemp = (totaaltemp | resultstemp[1]) << 4;
@@ -218,8 +491,7 @@ uint32_t bmp280::readTemperatureRaw() {
 // Reads the raw pressure data
 uint32_t bmp280::readPressureRaw() {
     int32_t totaalpress = 0x00;
-    write(0xF7);
-    read(resultspress, 3);
+    readRegisters(0xF7, resultspress, 3);
     int32_t newresultpressure = resultspress[2] >> 4;
     totaalpress = resultspress[0] << 8;
     totaalpress = (totaalpress | resultspress[1]) << 4;
@@ -227,6 +499,7 @@ uint32_t bmp280::readPressureRaw() {
 }
 
 void bmp280::printCalibrationData() {
+    requireCalibration();
     hwlib::cout << "Calibration Data:" << hwlib::dec << hwlib::endl;
     hwlib::cout << "dig_T1: " << calibration_data.dig_T1 << hwlib::endl;
     hwlib::cout << "dig_T2: " << calibration_data.dig_T2 << hwlib::endl;
@@ -240,28 +513,56 @@ void bmp280::printCalibrationData() {
     hwlib::cout << "dig_P7: " << calibration_data.dig_P7 << hwlib::endl;
     hwlib::cout << "dig_P8: " << calibration_data.dig_P8 << hwlib::endl;
     hwlib::cout << "dig_P9: " << calibration_data.dig_P9 << hwlib::endl;
+    if (hasHumidity()) {
+        hwlib::cout << "dig_H1: " << static_cast<int>(humidity_calibration.dig_H1) << hwlib::endl;
+        hwlib::cout << "dig_H2: " << humidity_calibration.dig_H2 << hwlib::endl;
+        hwlib::cout << "dig_H3: " << static_cast<int>(humidity_calibration.dig_H3) << hwlib::endl;
+        hwlib::cout << "dig_H4: " << humidity_calibration.dig_H4 << hwlib::endl;
+        hwlib::cout << "dig_H5: " << humidity_calibration.dig_H5 << hwlib::endl;
+        hwlib::cout << "dig_H6: " << static_cast<int>(humidity_calibration.dig_H6) << hwlib::endl;
+    }
+}
+
+// Reads all registers from the chip ID up to the last data register in one burst
+bmp280_register_snapshot bmp280::snapshot() {
+    bmp280_register_snapshot registers;
+    readRegisters(BMP280_CHIP_ID_REG, registers.registers, BMP280_SNAPSHOT_LENGTH);
+    return registers;
 }
 
-// Must be 0x58 when read
 void bmp280::printIDRegister() {
-    uint8_t id = read8(BMP280_CHIP_ID_REG); 
+    printIDRegister(snapshot());
+}
+
+// Must be 0x58 for a BMP280 or 0x60 for a BME280 when read
+void bmp280::printIDRegister(const bmp280_register_snapshot& registers) {
+    uint8_t id = registers.get(BMP280_CHIP_ID_REG);
     
     hwlib::cout << "ID Register:" << hwlib::endl;
     hwlib::cout << "Hexadecimal: 0x" << hwlib::hex << hwlib::setw(2) << hwlib::setfill('0') << id << hwlib::endl;
-    hwlib::cout << "Decimal: " << hwlib::dec << id << hwlib::endl << hwlib::endl;
+    hwlib::cout << "Decimal: " << hwlib::dec << id << hwlib::endl;
+    hwlib::cout << "Chip: " << (id == BMP280_CHIP_ID ? "BMP280" : id == BME280_CHIP_ID ? "BME280" : "unknown") << hwlib::endl << hwlib::endl;
 }
 
-// Must be 0x00 when read
 void bmp280::printResetRegister() {
-    uint8_t reset = read8(BMP280_RESET_REG);
+    printResetRegister(snapshot());
+}
+
+// Must be 0x00 when read
+void bmp280::printResetRegister(const bmp280_register_snapshot& registers) {
+    uint8_t reset = registers.get(BMP280_RESET_REG);
     
     hwlib::cout << "Reset Register:" << hwlib::endl;
     hwlib::cout << "0x" << hwlib::hex << hwlib::setw(2) << hwlib::setfill('0') << reset << hwlib::endl << hwlib::endl;
 }
 
 void bmp280::printPowerMode() {
-    // Read the current value of the control register
-    uint8_t ctrl_meas = read8(BMP280_CTRL_REG);
+    printPowerMode(snapshot());
+}
+
+void bmp280::printPowerMode(const bmp280_register_snapshot& registers) {
+    // Take the value of the control register from the snapshot
+    uint8_t ctrl_meas = registers.get(BMP280_CTRL_REG);
 
     // Extract the power mode bits (bit 1 and bit 0)
     uint8_t power_mode = ctrl_meas & 0b11;
@@ -286,8 +587,12 @@ void bmp280::printPowerMode() {
 }
 
 void bmp280::printOversamplingSettings() {
-    // Read the current value of the control register
-    uint8_t ctrl_meas = read8(BMP280_CTRL_REG);
+    printOversamplingSettings(snapshot());
+}
+
+void bmp280::printOversamplingSettings(const bmp280_register_snapshot& registers) {
+    // Take the value of the control register from the snapshot
+    uint8_t ctrl_meas = registers.get(BMP280_CTRL_REG);
 
     // Extract the osrs_t and osrs_p bits (bits 7:5 and 4:2)
     uint8_t osrs_t = (ctrl_meas >> 5) & 0b111;
@@ -301,8 +606,12 @@ void bmp280::printOversamplingSettings() {
 
 // Prints the current filter settings.
 void bmp280::printFilterSettings() {
-    // Read the current value of the configuration register
-    uint8_t config = read8(BMP280_CONFIG_REG);
+    printFilterSettings(snapshot());
+}
+
+void bmp280::printFilterSettings(const bmp280_register_snapshot& registers) {
+    // Take the value of the configuration register from the snapshot
+    uint8_t config = registers.get(BMP280_CONFIG_REG);
 
     // Extract the filter bits (bits 4:2)
     uint8_t filter = (config >> 2) & 0b111;
@@ -313,37 +622,76 @@ void bmp280::printFilterSettings() {
 }
 
 void bmp280::printRawData() {
-    uint32_t raw_temp = readTemperatureRaw();
-    uint32_t raw_press = readPressureRaw();
+    bmp280_raw_sample raw = readSampleRaw();
+
+    hwlib::cout << "Raw Temperature Data: " << hwlib::dec << raw.temperature << hwlib::endl;
+    hwlib::cout << "Raw Pressure Data: " << hwlib::dec << raw.pressure << hwlib::endl << hwlib::endl;
+}
+
+void bmp280::printRawData(const bmp280_register_snapshot& registers) {
+    // The data registers are stored as msb, lsb and the top 4 bits of xlsb
+    uint32_t raw_press = (static_cast<uint32_t>(registers.get(0xF7)) << 12) | (static_cast<uint32_t>(registers.get(0xF8)) << 4) | (registers.get(0xF9) >> 4);
+    uint32_t raw_temp = (static_cast<uint32_t>(registers.get(0xFA)) << 12) | (static_cast<uint32_t>(registers.get(0xFB)) << 4) | (registers.get(0xFC) >> 4);
 
     hwlib::cout << "Raw Temperature Data: " << hwlib::dec << raw_temp << hwlib::endl;
     hwlib::cout << "Raw Pressure Data: " << hwlib::dec << raw_press << hwlib::endl << hwlib::endl;
 }
 
 void bmp280::printCompensatedData() {
-    double temp = getTemperature();
-    double press = getPressure();
+    bmp280_sample sample = readSample();
 
-    hwlib::cout << "Compensated Temperature: " << static_cast<int>(temp) << " _C" << hwlib::endl;
-    hwlib::cout << "Compensated Pressure: " << static_cast<int>(press) << " Pa" << hwlib::endl;
+    hwlib::cout << "Compensated Temperature: " << static_cast<int>(sample.temperature) << " _C" << hwlib::endl;
+    hwlib::cout << "Compensated Pressure: " << static_cast<int>(sample.pressure) << " Pa" << hwlib::endl;
 }
 
 void bmp280::printDebug() {
     hwlib::cout << "DEBUG INFO" << hwlib::endl;
     
     hwlib::cout << "-----" << hwlib::endl << hwlib::endl;
+
+    // Read all registers once and decode everything from the snapshot
+    bmp280_register_snapshot registers = snapshot();
     
-    printIDRegister();
+    printIDRegister(registers);
     
-    printResetRegister();
+    printResetRegister(registers);
     
-    printPowerMode();
+    printPowerMode(registers);
     
-    printOversamplingSettings();
+    printOversamplingSettings(registers);
     
-    printFilterSettings();
+    printFilterSettings(registers);
     
     printCalibrationData();
     
     hwlib::cout << hwlib::endl;
-}
\ No newline at end of file
+}
+
+void bmp280::printStats() {
+#ifdef BMP280_INSTRUMENTATION
+    hwlib::cout << "STATS" << hwlib::endl;
+    hwlib::cout << "-----" << hwlib::endl << hwlib::endl;
+
+    hwlib::cout << "Transactions: " << hwlib::dec << stats.transactions << hwlib::endl;
+    hwlib::cout << "Bytes: " << stats.bytes << hwlib::endl;
+    hwlib::cout << "Bus time: " << static_cast<uint32_t>(stats.bus_time_us) << " us" << hwlib::endl << hwlib::endl;
+
+    stats.temperature.print("Temperature");
+    stats.pressure.print("Pressure");
+    stats.compensation.print("Compensation");
+#else
+    hwlib::cout << "Instrumentation is disabled, define BMP280_INSTRUMENTATION to enable it" << hwlib::endl;
+#endif
+}
+
+void bmp280::resetStats() {
+#ifdef BMP280_INSTRUMENTATION
+    stats = bmp280_stats();
+#endif
+}
+
+#ifdef BMP280_INSTRUMENTATION
+const bmp280_stats& bmp280::getStats() const {
+    return stats;
+}
+#endif
\ No newline at end of file
@@ -3,6 +3,11 @@
 
 #include "hwlib.hpp"
 #include "bmp280_defs.hpp"
+#include "bmp280_compensation.hpp"
+#include "bmp280_calibration.hpp"
+#include "bmp280_stats.hpp"
+#include "bmp280_transport.hpp"
+#include "bmp280_tuning.hpp"
 
 /**
  * @class bmp280
@@ -20,23 +25,37 @@
 class bmp280 {
 
 private:
-    hwlib::i2c_bus& bus; /**< hwlib i2c bus for communication with the sensor */
-    uint8_t i2c_address; /**< Stores the BMP280's i2c slave address */
+    bmp280_i2c_transport i2c_transport; /**< Transport used when the sensor is constructed with an i2c bus */
+    bmp280_transport& transport;        /**< Register access to the sensor, i2c_transport or a transport passed by the user */
 
     bmp280_calibration_data calibration_data; /**< Struct to hold calibration data */
+    bmp280_compensation_plan compensation_plan; /**< Calibration data pre-scaled for getTemperature() and getPressure() */
 
-    /**
-     * @brief Write data to the sensor.
-     * @param data The data to be written.
-     */
-    void write(uint8_t data);
+    uint8_t ctrl_meas_shadow; /**< Last value written to the ctrl_meas register */
+    uint8_t config_shadow;    /**< Last value written to the config register */
+    uint8_t ctrl_hum_shadow;  /**< Humidity oversampling written to the ctrl_hum register of a BME280 */
+
+    uint8_t chip_id;                                  /**< Value of the chip ID register */
+    bme280_humidity_calibration humidity_calibration; /**< Humidity calibration data, only on a BME280 */
+
+    bool chip_detected;       /**< True once chip_id is read, and for a BME280 the humidity calibration */
+    bool calibration_loaded;  /**< True once calibration_data holds the calibration of the sensor */
+    bool shadows_loaded;      /**< True once the shadow copies match the registers of the sensor */
+
+    bool measurement_pending;            /**< True while a measurement started by startMeasurement() hasn't been polled as done */
+    uint_fast64_t measurement_ready_us;  /**< Time at which the pending measurement is expected to be done */
+
+#ifdef BMP280_INSTRUMENTATION
+    bmp280_stats stats; /**< Bus and compute instrumentation, see bmp280_stats.hpp */
+#endif
 
     /**
-     * @brief Read data from the sensor.
+     * @brief Read consecutive registers in a single burst.
+     * @param reg The address of the first register.
      * @param data Pointer to the buffer where the data will be stored.
-     * @param data_size The size of the data to be read.
+     * @param data_size The number of registers to read.
      */
-    void read(uint8_t* data, int data_size);
+    void readRegisters(uint8_t reg, uint8_t* data, int data_size);
 
     /**
      * @brief Read an 8-bit value from the sensor.
@@ -60,7 +79,7 @@ private:
     uint16_t read16u(uint8_t reg);
 
     /**
-     * @brief Read a 20-bit unsigned value from the sensor.
+     * @brief Read a 20-bit unsigned value from the sensor in a single burst.
      * @param reg The register address to read from.
      * @return The 20-bit unsigned value read from the register.
      */
@@ -68,8 +87,28 @@ private:
 
     /**
      * @brief Load calibration data from the sensor.
+     *
+     * Reads all calibration registers in a single burst.
      */
     void loadCalibration();
+
+    /**
+     * @brief Load the calibration data from the sensor if it wasn't loaded or injected yet.
+     */
+    void requireCalibration();
+
+    /**
+     * @brief Read ctrl_meas and config into the shadow copies if they aren't known yet.
+     */
+    void requireShadows();
+
+    /**
+     * @brief Read the chip ID if it isn't known yet.
+     *
+     * On a BME280 this also reads the humidity calibration and writes ctrl_hum, so humidity is measured
+     * from the next conversion on.
+     */
+    void requireChip();
     
     /**
      * @brief Read the raw temperature data from the sensor.
@@ -83,14 +122,107 @@ private:
      */
     uint32_t readPressureRaw();
 
+protected:
+    /**
+     * @brief Write one or more registers in a single burst.
+     *
+     * The data consists of register address and value pairs, as described in Chapter 5.2.1 and 5.3.1 of the datasheet.
+     * @param data The register address and value pairs.
+     * @param data_size The number of bytes in data, twice the number of registers.
+     */
+    void writeRegisters(const uint8_t* data, int data_size);
+
+    /**
+     * @brief Write the ctrl_meas and config registers in a single transaction and update the shadow copies.
+     * @param ctrl_meas The new value of the ctrl_meas register.
+     * @param config The new value of the config register.
+     */
+    void writeConfiguration(uint8_t ctrl_meas, uint8_t config);
+
 public:
     /**
      * @brief Constructor for the bmp280 class.
+     *
+     * The constructor doesn't use the bus, so it is safe during static construction. The calibration
+     * data and the current configuration are read on first use, or right away with initialize().
      * @param bus The hwlib i2c bus for communication with the sensor.
      * @param i2c_address The BMP280's i2c slave address. Default is 0x76.
      */
     bmp280(hwlib::i2c_bus& bus, uint8_t i2c_address = 0x76);
 
+    /**
+     * @brief Constructor for the bmp280 class with stored calibration data.
+     *
+     * If the CRC of the blob is correct the calibration registers are never read from the sensor.
+     * Otherwise the blob is ignored and the calibration data is read on first use.
+     * @param bus The hwlib i2c bus for communication with the sensor.
+     * @param calibration A blob written by getCalibrationBlob(), for example stored in flash.
+     * @param i2c_address The BMP280's i2c slave address. Default is 0x76.
+     */
+    bmp280(hwlib::i2c_bus& bus, const bmp280_calibration_blob& calibration, uint8_t i2c_address = 0x76);
+
+    /**
+     * @brief Constructor for the bmp280 class with another transport, for example bmp280_spi_transport.
+     * @param transport The register access to the sensor, it must outlive the bmp280 object.
+     */
+    bmp280(bmp280_transport& transport);
+
+    /**
+     * @brief Constructor for the bmp280 class with another transport and stored calibration data.
+     * @param transport The register access to the sensor, it must outlive the bmp280 object.
+     * @param calibration A blob written by getCalibrationBlob(), ignored if its CRC is wrong.
+     */
+    bmp280(bmp280_transport& transport, const bmp280_calibration_blob& calibration);
+
+    /**
+     * @brief A copy would keep using the transport of the original, which may be the original's own i2c_transport.
+     */
+    bmp280(const bmp280&) = delete;
+
+    /**
+     * @brief See the deleted copy constructor.
+     */
+    bmp280& operator=(const bmp280&) = delete;
+
+    /**
+     * @brief Read the chip ID, the calibration data and the current configuration now instead of on first use.
+     */
+    void initialize();
+
+    /**
+     * @brief Get the chip ID, to tell a BMP280 from a BME280.
+     * @return BMP280_CHIP_ID, BME280_CHIP_ID, or another value if no known sensor answers.
+     */
+    uint8_t getChipId();
+
+    /**
+     * @brief Check whether the sensor measures humidity.
+     * @return True if the sensor is a BME280.
+     */
+    bool hasHumidity();
+
+    /**
+     * @brief Set the humidity oversampling of a BME280, does nothing on a BMP280.
+     *
+     * The default is x1. A change of ctrl_hum only takes effect after a write to ctrl_meas, see Chapter 5.4.3 of
+     * the BME280 datasheet, so both are written in one transaction.
+     * @param osrs_h The oversampling setting for humidity, SAMPLING_NONE to skip the humidity measurement.
+     */
+    void setHumidityOversampling(sampling_config osrs_h);
+
+    /**
+     * @brief Use stored calibration data instead of reading it from the sensor.
+     * @param calibration A blob written by getCalibrationBlob().
+     * @return True if the CRC of the blob is correct and the calibration data was replaced.
+     */
+    bool setCalibration(const bmp280_calibration_blob& calibration);
+
+    /**
+     * @brief Get the calibration data as a CRC protected blob that can be stored and passed to the constructor.
+     * @return The calibration blob, the calibration data is read from the sensor first if needed.
+     */
+    bmp280_calibration_blob getCalibrationBlob();
+
     /**
      * @brief Setup the sensor by configuring settings for your use case.
      */
@@ -115,8 +247,79 @@ public:
      */
     void setFilter(filter_config filter);
 
+    /**
+     * @brief Set the standby time between conversions in normal mode.
+     * @param standby The standby time to set.
+     */
+    void setStandby(standby_config standby);
+
+    /**
+     * @brief Apply the settings picked by tuneConfiguration() in a single write.
+     *
+     * In forced mode the sensor is left in sleep mode, start each conversion with startMeasurement().
+     * @param tuning The settings, ignored if they aren't feasible.
+     * @return The value of tuning.feasible.
+     */
+    bool configure(const bmp280_tuning& tuning);
+
+    /**
+     * @brief Get the time between the start of two conversions in normal mode with the current settings.
+     * @return The maximum measurement time plus the standby time in microseconds.
+     */
+    uint32_t normalModePeriod();
+
+    /**
+     * @brief Read the status register.
+     * @return The status register value, see BMP280_STATUS_MEASURING and BMP280_STATUS_IM_UPDATE.
+     */
+    uint8_t readStatus();
+
+    /**
+     * @brief Get the maximum duration of a conversion with the current oversampling settings.
+     * @return The maximum measurement time in microseconds.
+     */
+    uint32_t measurementTime();
+
+    /**
+     * @brief Start a forced mode conversion without waiting for it.
+     *
+     * Use remainingMeasurementTime() and poll() to find out when it is done, then collect() or collectInt() to read it.
+     */
+    void startMeasurement();
+
+    /**
+     * @brief Get the time until the started conversion is expected to be done.
+     *
+     * Callers can sleep this long before calling poll(), so they never wait longer than needed.
+     * @return The remaining time in microseconds, 0 if the conversion should be done already.
+     */
+    uint32_t remainingMeasurementTime();
+
+    /**
+     * @brief Check whether the started conversion is done.
+     *
+     * Before the expected measurement time has passed this returns false without using the bus.
+     * After that the measuring bit of the status register is checked.
+     * @return True if the conversion is done or no conversion was started.
+     */
+    bool poll();
+
+    /**
+     * @brief Read and compensate the result of a finished conversion.
+     * @return The compensated temperature and pressure.
+     */
+    bmp280_sample collect();
+
+    /**
+     * @brief Read and compensate the result of a finished conversion using integer arithmetic only.
+     * @return The temperature in 0.01 degrees Celsius and the pressure in Pa as Q24.8 fixed point.
+     */
+    bmp280_sample_int collectInt();
+
     /**
      * @brief Compensate the temperature data and return the compensated value.
+     *
+     * Uses the float compensation plan, see bmp280_compensation_plan for the accuracy.
      * @return The compensated temperature value.
      */
     double getTemperature();
@@ -127,16 +330,95 @@ public:
      */
     double getPressure();
 
+    /**
+     * @brief Get the calibration data loaded from the sensor.
+     *
+     * Raw readings can be compensated later with the functions from bmp280_compensation.hpp and this data.
+     * @return The calibration data.
+     */
+    const bmp280_calibration_data& getCalibrationData();
+
+    /**
+     * @brief Read the raw temperature and pressure data in a single burst.
+     * @return The raw temperature and pressure of the same conversion.
+     */
+    bmp280_raw_sample readSampleRaw();
+
+    /**
+     * @brief Read and compensate the temperature and pressure of the same conversion.
+     *
+     * Unlike calling getTemperature() and getPressure() separately, this needs a single bus
+     * transaction pair and the pressure is always compensated with the t_fine of its own conversion.
+     * @return The compensated temperature and pressure.
+     */
+    bmp280_sample readSample();
+
+    /**
+     * @brief Compensate the temperature data using integer arithmetic only.
+     * @return The compensated temperature in 0.01 degrees Celsius.
+     */
+    int32_t getTemperatureInt();
+
+    /**
+     * @brief Compensate the pressure data using integer arithmetic only.
+     *
+     * Like getPressure(), this uses the t_fine of the last temperature reading.
+     * @return The compensated pressure in Pa as Q24.8 fixed point.
+     */
+    uint32_t getPressureInt();
+
+    /**
+     * @brief Read and compensate the temperature and pressure of the same conversion using integer arithmetic only.
+     *
+     * This is the preferred path on targets without an FPU, such as the Arduino Due.
+     * @return The temperature in 0.01 degrees Celsius and the pressure in Pa as Q24.8 fixed point.
+     */
+    bmp280_sample_int readSampleInt();
+
+    /**
+     * @brief Read and compensate the temperature, pressure and humidity of the same conversion using integer arithmetic only.
+     *
+     * On a BME280 the burst covers 0xF7..0xFE, only two bytes more than readSampleInt(), so the humidity costs
+     * no extra transaction. On a BMP280 only 0xF7..0xFC is read and the humidity is 0. The humidity is 0 on a
+     * BME280 too when it was skipped, see BME280_RAW_HUMIDITY_SKIPPED.
+     * @return The temperature, pressure and humidity in fixed point.
+     */
+    bme280_sample_int readHumiditySampleInt();
+
+    /**
+     * @brief Read and compensate the result of a finished conversion including the humidity, see readHumiditySampleInt().
+     * @return The temperature, pressure and humidity in fixed point.
+     */
+    bme280_sample_int collectHumiditySampleInt();
+
+    /**
+     * @brief Read the registers 0xD0..0xFC in a single burst.
+     * @return The register values.
+     */
+    bmp280_register_snapshot snapshot();
+
     /**
      * @brief Print the ID register value.
      */
     void printIDRegister();
 
+    /**
+     * @brief Print the ID register value from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printIDRegister(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Print the reset register value.
      */
     void printResetRegister();
 
+    /**
+     * @brief Print the reset register value from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printResetRegister(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Print the calibration data.
      */
@@ -147,21 +429,45 @@ public:
      */
     void printPowerMode();
 
+    /**
+     * @brief Print the power mode setting from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printPowerMode(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Print the oversampling settings for temperature and pressure measurements.
      */
     void printOversamplingSettings();
 
+    /**
+     * @brief Print the oversampling settings for temperature and pressure measurements from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printOversamplingSettings(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Print the filter settings.
      */
     void printFilterSettings();
 
+    /**
+     * @brief Print the filter settings from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printFilterSettings(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Print the raw temperature and pressure data.
      */
     void printRawData();
 
+    /**
+     * @brief Print the raw temperature and pressure data from a snapshot.
+     * @param registers The register snapshot to decode.
+     */
+    void printRawData(const bmp280_register_snapshot& registers);
+
     /**
      * @brief Printthe compensated temperature and pressure data.
      */
@@ -169,9 +475,31 @@ public:
 
     /**
      * @brief Print debug information.
+     *
+     * All register values come from a single snapshot.
      */
     void printDebug();
 
+    /**
+     * @brief Print the bus and compute instrumentation.
+     *
+     * Only prints a note when the library is built without BMP280_INSTRUMENTATION.
+     */
+    void printStats();
+
+    /**
+     * @brief Reset the bus and compute instrumentation, does nothing without BMP280_INSTRUMENTATION.
+     */
+    void resetStats();
+
+#ifdef BMP280_INSTRUMENTATION
+    /**
+     * @brief Get the bus and compute instrumentation.
+     * @return The instrumentation collected since construction or the last resetStats().
+     */
+    const bmp280_stats& getStats() const;
+#endif
+
     /**
     *   The following variables were written by Bas van den Bergh, a Computer Engineering student at HU.
     *   Source: https://github.com/BasvandenBergh/IPASS_jaar1_BAS
@@ -0,0 +1,120 @@
+#include "bmp280_altitude.hpp"
+#include <string.h>
+#include <math.h>
+
+// 1 / 5.255, the exponent of the barometric formula
+static constexpr float BAROMETRIC_EXPONENT = 0.190295f;
+
+// The coefficients are Chebyshev interpolations of log2(1 + t) for t in -0.25..0.5 and of 2^f for f in -0.5..0.5
+float bmp280FastLog2(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127;
+
+    // Replace the exponent by 0 to get the mantissa between 1 and 2
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    // Keep the mantissa between 0.75 and 1.5, where the polynomial is most accurate
+    if (mantissa > 1.5f) {
+        mantissa *= 0.5f;
+        exponent++;
+    }
+
+    float t = mantissa - 1.0f;
+    float log = 0.108180492f;
+    log = log * t - 0.235743167f;
+    log = log * t + 0.299800838f;
+    log = log * t - 0.362632022f;
+    log = log * t + 0.480553251f;
+    log = log * t - 0.721284443f;
+    log = log * t + 1.44269794f;
+    log = log * t - 2.61599359e-07f;
+    return log + static_cast<float>(exponent);
+}
+
+float bmp280FastExp2(float x) {
+    if (x < -126.0f) {
+        x = -126.0f;
+    } else if (x > 127.0f) {
+        x = 127.0f;
+    }
+
+    // Split into a whole exponent and a fraction between -0.5 and 0.5. Adding 1.5 * 2^23 rounds x to
+    // the nearest integer, which ends up in the low bits of the sum
+    float rounded = x + 12582912.0f;
+    int32_t whole;
+    memcpy(&whole, &rounded, sizeof(whole));
+    whole -= 0x4B400000;
+    float f = x - (rounded - 12582912.0f);
+
+    float exp = 0.00133908634f;
+    exp = exp * f + 0.00967603192f;
+    exp = exp * f + 0.0555035711f;
+    exp = exp * f + 0.240221075f;
+    exp = exp * f + 0.693147188f;
+    exp = exp * f + 1.00000008f;
+
+    // Multiply by 2^whole by adding it to the exponent bits
+    uint32_t bits;
+    memcpy(&bits, &exp, sizeof(bits));
+    bits += static_cast<uint32_t>(whole) << 23;
+    memcpy(&exp, &bits, sizeof(exp));
+    return exp;
+}
+
+float bmp280FastPow(float x, float y) {
+    return bmp280FastExp2(y * bmp280FastLog2(x));
+}
+
+float pressureToAltitude(float pressure, float sea_level_pressure) {
+    return 44330.0f * (1.0f - bmp280FastPow(pressure / sea_level_pressure, BAROMETRIC_EXPONENT));
+}
+
+float seaLevelPressure(float pressure, float altitude) {
+    return pressure * bmp280FastPow(1.0f - altitude / 44330.0f, -5.255f);
+}
+
+double pressureToAltitudeExact(double pressure, double sea_level_pressure) {
+    return 44330.0 * (1.0 - pow(pressure / sea_level_pressure, 1.0 / 5.255));
+}
+
+double seaLevelPressureExact(double pressure, double altitude) {
+    return pressure / pow(1.0 - altitude / 44330.0, 5.255);
+}
+
+bmp280_vertical_speed::bmp280_vertical_speed(float time_constant_s) :
+    time_constant_s(time_constant_s), last_altitude(0), last_us(0), speed(0), started(false)
+{}
+
+float bmp280_vertical_speed::update(float altitude, uint_fast64_t timestamp_us) {
+    if (!started || timestamp_us <= last_us) {
+        // The first altitude, or a timestamp that doesn't move forward, gives no speed
+        if (!started) {
+            last_us = timestamp_us;
+        }
+        last_altitude = altitude;
+        started = true;
+        return speed;
+    }
+
+    float dt = static_cast<float>(timestamp_us - last_us) * 1e-6f;
+    float instant = (altitude - last_altitude) / dt;
+
+    // Discrete first order low-pass filter, alpha = dt / (tau + dt)
+    speed += (instant - speed) * (dt / (time_constant_s + dt));
+
+    last_altitude = altitude;
+    last_us = timestamp_us;
+    return speed;
+}
+
+float bmp280_vertical_speed::get() const {
+    return speed;
+}
+
+void bmp280_vertical_speed::reset() {
+    speed = 0;
+    started = false;
+}
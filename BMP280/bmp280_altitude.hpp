@@ -0,0 +1,126 @@
+/**
+ * @file bmp280_altitude.hpp
+ * @brief Altitude, sea level pressure and vertical speed from pressure readings.
+ *
+ * The formulas are those of the international barometric formula:
+ * altitude = 44330 * (1 - (pressure / sea_level_pressure)^(1 / 5.255)).
+ *
+ * The default functions raise to the power with bmp280FastLog2() and bmp280FastExp2(), which only need float
+ * multiply-adds. From 300 to 1100 hPa (and a sea level pressure of 1013.25 hPa) they stay within 0.01 m of the
+ * exact formula, and seaLevelPressure() stays within 0.2 Pa. The ...Exact() functions use pow() in double
+ * precision. They are separate functions, so firmware that only uses the fast ones doesn't link in pow().
+ */
+
+#ifndef BMP280_ALTITUDE_HPP
+#define BMP280_ALTITUDE_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Standard sea level pressure in Pa.
+ */
+constexpr float BMP280_SEA_LEVEL_PRESSURE = 101325.0f;
+
+/**
+ * @brief Approximate log2(x) for a positive, normal x.
+ *
+ * The absolute error is below 1e-6.
+ * @param x The value, must be larger than 0.
+ * @return log2 of x.
+ */
+float bmp280FastLog2(float x);
+
+/**
+ * @brief Approximate 2^x for x between -126 and 127.
+ *
+ * The relative error is below 3e-7.
+ * @param x The exponent, values outside -126..127 are clamped.
+ * @return 2 to the power x.
+ */
+float bmp280FastExp2(float x);
+
+/**
+ * @brief Approximate x^y as 2^(y * log2(x)).
+ * @param x The base, must be larger than 0.
+ * @param y The exponent.
+ * @return x to the power y.
+ */
+float bmp280FastPow(float x, float y);
+
+/**
+ * @brief Calculate the altitude from a pressure reading.
+ * @param pressure The pressure in Pa, for example from getPressure() or getPressureInt() / 256.
+ * @param sea_level_pressure The pressure at sea level in Pa.
+ * @return The altitude in meters.
+ */
+float pressureToAltitude(float pressure, float sea_level_pressure = BMP280_SEA_LEVEL_PRESSURE);
+
+/**
+ * @brief Calculate the pressure at sea level from a pressure reading at a known altitude.
+ * @param pressure The pressure in Pa.
+ * @param altitude The altitude of the sensor in meters.
+ * @return The pressure at sea level in Pa, to pass to pressureToAltitude().
+ */
+float seaLevelPressure(float pressure, float altitude);
+
+/**
+ * @brief Calculate the altitude from a pressure reading using pow().
+ * @param pressure The pressure in Pa.
+ * @param sea_level_pressure The pressure at sea level in Pa.
+ * @return The altitude in meters.
+ */
+double pressureToAltitudeExact(double pressure, double sea_level_pressure = BMP280_SEA_LEVEL_PRESSURE);
+
+/**
+ * @brief Calculate the pressure at sea level from a pressure reading at a known altitude using pow().
+ * @param pressure The pressure in Pa.
+ * @param altitude The altitude of the sensor in meters.
+ * @return The pressure at sea level in Pa.
+ */
+double seaLevelPressureExact(double pressure, double altitude);
+
+/**
+ * @class bmp280_vertical_speed
+ * @brief Smoothed vertical speed from a series of altitudes.
+ *
+ * The speed between two altitudes is passed through a first order low-pass filter. A single altitude
+ * sample has about 0.1 m of noise at 16x oversampling (Chapter 3.8 of the datasheet), so without smoothing
+ * the speed between samples taken 40 ms apart would jump by several m/s.
+ **/
+class bmp280_vertical_speed {
+
+private:
+    float time_constant_s;     /**< Time constant of the low-pass filter */
+    float last_altitude;       /**< Altitude of the previous update */
+    uint_fast64_t last_us;     /**< Timestamp of the previous update */
+    float speed;               /**< Filtered vertical speed */
+    bool started;              /**< True once an altitude has been added */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_vertical_speed class.
+     * @param time_constant_s The time constant of the low-pass filter in seconds, 0 disables the filter.
+     */
+    bmp280_vertical_speed(float time_constant_s = 1.0f);
+
+    /**
+     * @brief Add an altitude.
+     * @param altitude The altitude in meters.
+     * @param timestamp_us The time of the reading, for example from hwlib::now_us().
+     * @return The filtered vertical speed in m/s, positive when rising.
+     */
+    float update(float altitude, uint_fast64_t timestamp_us);
+
+    /**
+     * @brief Get the filtered vertical speed.
+     * @return The vertical speed in m/s after the last update, positive when rising.
+     */
+    float get() const;
+
+    /**
+     * @brief Forget all altitudes, the next update starts at a speed of 0.
+     */
+    void reset();
+};
+
+#endif // BMP280_ALTITUDE_HPP
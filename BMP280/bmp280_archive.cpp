@@ -0,0 +1,64 @@
+#include "bmp280_archive.hpp"
+#include "bmp280_calibration.hpp"
+#include "bmp280_protocol.hpp"
+
+static const char archive_magic[8] = {'B', 'M', 'P', '2', '8', '0', 'A', 'R'};
+
+static void writeLittleEndian(uint8_t* data, uint64_t value, int size) {
+    for (int i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint64_t readLittleEndian(const uint8_t* data, int size) {
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+void writeArchiveHeader(const bmp280_archive_header& header, uint8_t* data) {
+    for (int i = 0; i < 8; i++) {
+        data[i] = static_cast<uint8_t>(archive_magic[i]);
+    }
+    data[8] = BMP280_ARCHIVE_VERSION;
+    data[9] = data[10] = data[11] = 0;
+    writeLittleEndian(data + 12, header.device_id, 4);
+    writeLittleEndian(data + 16, header.period_us, 4);
+    writeLittleEndian(data + 20, header.start_us, 8);
+    writeLittleEndian(data + 28, header.sample_count, 8);
+    for (int i = 0; i < BMP280_CALIBRATION_BLOB_LENGTH; i++) {
+        data[36 + i] = header.calibration.data[i];
+    }
+    writeLittleEndian(data + 62, bmp280Crc16(data, 62), 2);
+}
+
+bool readArchiveHeader(const uint8_t* data, size_t size, bmp280_archive_header& header) {
+    if (size < BMP280_ARCHIVE_HEADER_LENGTH) {
+        return false;
+    }
+    for (int i = 0; i < 8; i++) {
+        if (data[i] != static_cast<uint8_t>(archive_magic[i])) {
+            return false;
+        }
+    }
+    if (data[8] != BMP280_ARCHIVE_VERSION || bmp280Crc16(data, 62) != readLittleEndian(data + 62, 2)) {
+        return false;
+    }
+
+    header.device_id = static_cast<uint32_t>(readLittleEndian(data + 12, 4));
+    header.period_us = static_cast<uint32_t>(readLittleEndian(data + 16, 4));
+    header.start_us = readLittleEndian(data + 20, 8);
+    header.sample_count = readLittleEndian(data + 28, 8);
+    for (int i = 0; i < BMP280_CALIBRATION_BLOB_LENGTH; i++) {
+        header.calibration.data[i] = data[36 + i];
+    }
+
+    // A truncated file, for example one that is still being written, is rejected as a whole
+    return header.sample_count <= (size - BMP280_ARCHIVE_HEADER_LENGTH) / BMP280_RECORD_LENGTH;
+}
+
+bmp280_raw_sample readArchiveSample(const uint8_t* data, uint64_t index) {
+    return unpackRawSample(data + BMP280_ARCHIVE_HEADER_LENGTH + index * BMP280_RECORD_LENGTH);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file bmp280_archive.hpp
+ * @brief File format for archives of raw samples of one device.
+ *
+ * An archive is a 64 byte header followed by the raw samples, each packed into 5 bytes by packRawSample().
+ * Sample n was taken at start_us + n * period_us, so any sample or range of samples can be found without
+ * reading the samples before it, and a file can be split into parts that are processed independently.
+ *
+ * The header holds, multi-byte fields low byte first:
+ *
+ *     offset  0: "BMP280AR"
+ *     offset  8: version, followed by 3 zero bytes
+ *     offset 12: device ID (4 bytes)
+ *     offset 16: time between two samples in microseconds (4 bytes)
+ *     offset 20: time of the first sample in microseconds, for example since the Unix epoch (8 bytes)
+ *     offset 28: number of samples (8 bytes)
+ *     offset 36: calibration blob, as written by serializeCalibration() (26 bytes)
+ *     offset 62: CRC-16 of the bytes before it
+ *
+ * Samples that were lost in transfer are stored with both values set to BMP280_RAW_SKIPPED.
+ */
+
+#ifndef BMP280_ARCHIVE_HPP
+#define BMP280_ARCHIVE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Version of the archive format.
+ */
+constexpr uint8_t BMP280_ARCHIVE_VERSION = 1;
+
+/**
+ * @brief Length of the archive header.
+ */
+constexpr uint8_t BMP280_ARCHIVE_HEADER_LENGTH = 64;
+
+/**
+ * @brief Raw value of a skipped measurement.
+ *
+ * The sensor reports this value for a measurement that is disabled, see Chapter 3.3.1 of the datasheet.
+ * It can't be the result of a real conversion, so archives use it to mark lost samples.
+ */
+constexpr uint32_t BMP280_RAW_SKIPPED = 0x80000;
+
+/**
+ * @struct bmp280_archive_header
+ * @brief Struct that holds the decoded header of an archive.
+ */
+typedef struct {
+    uint32_t device_id;                   /**< ID of the device the samples came from */
+    uint32_t period_us;                   /**< Time between two samples in microseconds */
+    uint64_t start_us;                    /**< Time of the first sample in microseconds */
+    uint64_t sample_count;                /**< Number of samples */
+    bmp280_calibration_blob calibration;  /**< Calibration data of the sensor */
+} bmp280_archive_header;
+
+/**
+ * @brief Encode an archive header.
+ * @param header The header.
+ * @param data Receives the BMP280_ARCHIVE_HEADER_LENGTH bytes of the header.
+ */
+void writeArchiveHeader(const bmp280_archive_header& header, uint8_t* data);
+
+/**
+ * @brief Decode and check an archive header.
+ * @param data The archive, at least the header.
+ * @param size The size of the archive in bytes.
+ * @param header Receives the header.
+ * @return False if the magic, version or CRC is wrong, or the archive is shorter than the header says.
+ */
+bool readArchiveHeader(const uint8_t* data, size_t size, bmp280_archive_header& header);
+
+/**
+ * @brief Get a sample from an archive.
+ * @param data The archive.
+ * @param index The index of the sample, less than the sample count in the header.
+ * @return The raw sample.
+ */
+bmp280_raw_sample readArchiveSample(const uint8_t* data, uint64_t index);
+
+#endif // BMP280_ARCHIVE_HPP
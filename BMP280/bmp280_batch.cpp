@@ -0,0 +1,196 @@
+#include "bmp280_batch.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// The formulas of Chapter 8.1 of the datasheet, with the calibration terms that don't depend on the reading
+// precalculated. Each step matches the order of operations in compensateTemperature() and compensatePressure().
+struct batch_constants {
+    double t1_1024;   // dig_T1 / 1024.0
+    double t1_8192;   // dig_T1 / 8192.0
+    double t2;
+    double t3;
+    double p1;
+    double p2;
+    double p3;
+    double p4_65536;  // dig_P4 * 65536.0
+    double p5;
+    double p6;
+    double p7;
+    double p8;
+    double p9;
+
+    batch_constants(const bmp280_calibration_data& calibration) :
+        t1_1024(((double)calibration.dig_T1) / 1024.0),
+        t1_8192(((double)calibration.dig_T1) / 8192.0),
+        t2(calibration.dig_T2),
+        t3(calibration.dig_T3),
+        p1(calibration.dig_P1),
+        p2(calibration.dig_P2),
+        p3(calibration.dig_P3),
+        p4_65536(((double)calibration.dig_P4) * 65536.0),
+        p5(calibration.dig_P5),
+        p6(calibration.dig_P6),
+        p7(calibration.dig_P7),
+        p8(calibration.dig_P8),
+        p9(calibration.dig_P9)
+    {}
+};
+
+// Branch free, so compilers can vectorize it
+void compensateScalar(const batch_constants& c, const uint32_t* raw_temp, const uint32_t* raw_press,
+                      size_t count, double* temperature, double* pressure) {
+    for (size_t i = 0; i < count; i++) {
+        double raw_t = (double)raw_temp[i];
+        double var1 = (raw_t * (1.0 / 16384.0) - c.t1_1024) * c.t2;
+        double var2 = ((raw_t * (1.0 / 131072.0) - c.t1_8192) * (raw_t * (1.0 / 131072.0) - c.t1_8192)) * c.t3;
+        int32_t t_fine = (int32_t)(var1 + var2);
+        temperature[i] = (var1 + var2) / 5120.0;
+
+        var1 = ((double)t_fine * 0.5) - 64000.0;
+        var2 = var1 * var1 * c.p6 * (1.0 / 32768.0);
+        var2 = var2 + var1 * c.p5 * 2.0;
+        var2 = (var2 * 0.25) + c.p4_65536;
+        var1 = (c.p3 * var1 * var1 * (1.0 / 524288.0) + c.p2 * var1) * (1.0 / 524288.0);
+        var1 = (1.0 + var1 * (1.0 / 32768.0)) * c.p1;
+        double p = 1048576.0 - (double)raw_press[i];
+        p = (p - (var2 * (1.0 / 4096.0))) * 6250.0 / var1;
+        double var3 = c.p9 * p * p * (1.0 / 2147483648.0);
+        double var4 = p * c.p8 * (1.0 / 32768.0);
+        p = p + (var3 + var4 + c.p7) * (1.0 / 16.0);
+        pressure[i] = var1 == 0 ? 0 : p;
+    }
+}
+
+#if defined(__AVX__)
+
+void compensateVector(const batch_constants& c, const uint32_t* raw_temp, const uint32_t* raw_press,
+                      size_t count, double* temperature, double* pressure) {
+    const __m256d t1_1024 = _mm256_set1_pd(c.t1_1024);
+    const __m256d t1_8192 = _mm256_set1_pd(c.t1_8192);
+    const __m256d t2 = _mm256_set1_pd(c.t2);
+    const __m256d t3 = _mm256_set1_pd(c.t3);
+    const __m256d p1 = _mm256_set1_pd(c.p1);
+    const __m256d p2 = _mm256_set1_pd(c.p2);
+    const __m256d p3 = _mm256_set1_pd(c.p3);
+    const __m256d p4_65536 = _mm256_set1_pd(c.p4_65536);
+    const __m256d p5 = _mm256_set1_pd(c.p5);
+    const __m256d p6 = _mm256_set1_pd(c.p6);
+    const __m256d p7 = _mm256_set1_pd(c.p7);
+    const __m256d p8 = _mm256_set1_pd(c.p8);
+    const __m256d p9 = _mm256_set1_pd(c.p9);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // The readings are 20-bit, so converting them as signed integers is exact
+        __m256d raw_t = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw_temp + i)));
+        __m256d var1 = _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(raw_t, _mm256_set1_pd(1.0 / 16384.0)), t1_1024), t2);
+        __m256d diff = _mm256_sub_pd(_mm256_mul_pd(raw_t, _mm256_set1_pd(1.0 / 131072.0)), t1_8192);
+        __m256d var2 = _mm256_mul_pd(_mm256_mul_pd(diff, diff), t3);
+        __m256d fine = _mm256_add_pd(var1, var2);
+        __m256d t_fine = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(fine));
+        _mm256_storeu_pd(temperature + i, _mm256_div_pd(fine, _mm256_set1_pd(5120.0)));
+
+        var1 = _mm256_sub_pd(_mm256_mul_pd(t_fine, _mm256_set1_pd(0.5)), _mm256_set1_pd(64000.0));
+        var2 = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(var1, var1), p6), _mm256_set1_pd(1.0 / 32768.0));
+        var2 = _mm256_add_pd(var2, _mm256_mul_pd(_mm256_mul_pd(var1, p5), _mm256_set1_pd(2.0)));
+        var2 = _mm256_add_pd(_mm256_mul_pd(var2, _mm256_set1_pd(0.25)), p4_65536);
+        __m256d square = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(p3, var1), var1), _mm256_set1_pd(1.0 / 524288.0));
+        var1 = _mm256_mul_pd(_mm256_add_pd(square, _mm256_mul_pd(p2, var1)), _mm256_set1_pd(1.0 / 524288.0));
+        var1 = _mm256_mul_pd(_mm256_add_pd(one, _mm256_mul_pd(var1, _mm256_set1_pd(1.0 / 32768.0))), p1);
+
+        __m256d raw_p = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw_press + i)));
+        __m256d p = _mm256_sub_pd(_mm256_set1_pd(1048576.0), raw_p);
+        p = _mm256_sub_pd(p, _mm256_mul_pd(var2, _mm256_set1_pd(1.0 / 4096.0)));
+        p = _mm256_div_pd(_mm256_mul_pd(p, _mm256_set1_pd(6250.0)), var1);
+        __m256d var3 = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(p9, p), p), _mm256_set1_pd(1.0 / 2147483648.0));
+        __m256d var4 = _mm256_mul_pd(_mm256_mul_pd(p, p8), _mm256_set1_pd(1.0 / 32768.0));
+        p = _mm256_add_pd(p, _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(var3, var4), p7), _mm256_set1_pd(1.0 / 16.0)));
+
+        // Pressure is 0 where var1 is 0, like the division by zero check of compensatePressure()
+        _mm256_storeu_pd(pressure + i, _mm256_andnot_pd(_mm256_cmp_pd(var1, zero, _CMP_EQ_OQ), p));
+    }
+    compensateScalar(c, raw_temp + i, raw_press + i, count - i, temperature + i, pressure + i);
+}
+
+#elif defined(__SSE2__)
+
+void compensateVector(const batch_constants& c, const uint32_t* raw_temp, const uint32_t* raw_press,
+                      size_t count, double* temperature, double* pressure) {
+    const __m128d t1_1024 = _mm_set1_pd(c.t1_1024);
+    const __m128d t1_8192 = _mm_set1_pd(c.t1_8192);
+    const __m128d t2 = _mm_set1_pd(c.t2);
+    const __m128d t3 = _mm_set1_pd(c.t3);
+    const __m128d p1 = _mm_set1_pd(c.p1);
+    const __m128d p2 = _mm_set1_pd(c.p2);
+    const __m128d p3 = _mm_set1_pd(c.p3);
+    const __m128d p4_65536 = _mm_set1_pd(c.p4_65536);
+    const __m128d p5 = _mm_set1_pd(c.p5);
+    const __m128d p6 = _mm_set1_pd(c.p6);
+    const __m128d p7 = _mm_set1_pd(c.p7);
+    const __m128d p8 = _mm_set1_pd(c.p8);
+    const __m128d p9 = _mm_set1_pd(c.p9);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        // The readings are 20-bit, so converting them as signed integers is exact
+        __m128d raw_t = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw_temp + i)));
+        __m128d var1 = _mm_mul_pd(_mm_sub_pd(_mm_mul_pd(raw_t, _mm_set1_pd(1.0 / 16384.0)), t1_1024), t2);
+        __m128d diff = _mm_sub_pd(_mm_mul_pd(raw_t, _mm_set1_pd(1.0 / 131072.0)), t1_8192);
+        __m128d var2 = _mm_mul_pd(_mm_mul_pd(diff, diff), t3);
+        __m128d fine = _mm_add_pd(var1, var2);
+        __m128d t_fine = _mm_cvtepi32_pd(_mm_cvttpd_epi32(fine));
+        _mm_storeu_pd(temperature + i, _mm_div_pd(fine, _mm_set1_pd(5120.0)));
+
+        var1 = _mm_sub_pd(_mm_mul_pd(t_fine, _mm_set1_pd(0.5)), _mm_set1_pd(64000.0));
+        var2 = _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(var1, var1), p6), _mm_set1_pd(1.0 / 32768.0));
+        var2 = _mm_add_pd(var2, _mm_mul_pd(_mm_mul_pd(var1, p5), _mm_set1_pd(2.0)));
+        var2 = _mm_add_pd(_mm_mul_pd(var2, _mm_set1_pd(0.25)), p4_65536);
+        __m128d square = _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(p3, var1), var1), _mm_set1_pd(1.0 / 524288.0));
+        var1 = _mm_mul_pd(_mm_add_pd(square, _mm_mul_pd(p2, var1)), _mm_set1_pd(1.0 / 524288.0));
+        var1 = _mm_mul_pd(_mm_add_pd(one, _mm_mul_pd(var1, _mm_set1_pd(1.0 / 32768.0))), p1);
+
+        __m128d raw_p = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw_press + i)));
+        __m128d p = _mm_sub_pd(_mm_set1_pd(1048576.0), raw_p);
+        p = _mm_sub_pd(p, _mm_mul_pd(var2, _mm_set1_pd(1.0 / 4096.0)));
+        p = _mm_div_pd(_mm_mul_pd(p, _mm_set1_pd(6250.0)), var1);
+        __m128d var3 = _mm_mul_pd(_mm_mul_pd(_mm_mul_pd(p9, p), p), _mm_set1_pd(1.0 / 2147483648.0));
+        __m128d var4 = _mm_mul_pd(_mm_mul_pd(p, p8), _mm_set1_pd(1.0 / 32768.0));
+        p = _mm_add_pd(p, _mm_mul_pd(_mm_add_pd(_mm_add_pd(var3, var4), p7), _mm_set1_pd(1.0 / 16.0)));
+
+        // Pressure is 0 where var1 is 0, like the division by zero check of compensatePressure()
+        _mm_storeu_pd(pressure + i, _mm_andnot_pd(_mm_cmpeq_pd(var1, zero), p));
+    }
+    compensateScalar(c, raw_temp + i, raw_press + i, count - i, temperature + i, pressure + i);
+}
+
+#endif
+
+} // namespace
+
+void compensateBatch(const bmp280_calibration_data& calibration, const uint32_t* raw_temp, const uint32_t* raw_press,
+                     size_t count, double* temperature, double* pressure) {
+    batch_constants constants(calibration);
+#if defined(__AVX__) || defined(__SSE2__)
+    compensateVector(constants, raw_temp, raw_press, count, temperature, pressure);
+#else
+    compensateScalar(constants, raw_temp, raw_press, count, temperature, pressure);
+#endif
+}
+
+const char* compensateBatchInstructionSet() {
+#if defined(__AVX__)
+    return "AVX";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
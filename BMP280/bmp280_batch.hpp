@@ -0,0 +1,42 @@
+/**
+ * @file bmp280_batch.hpp
+ * @brief Compensation of large arrays of raw readings, for example logs pulled from the field.
+ *
+ * The raw readings are passed as a structure of arrays. The work is done with AVX or SSE2 when the compiler
+ * targets them, and with a plain loop that compilers can auto-vectorize otherwise.
+ *
+ * Every path performs the operations of compensateTemperature() and compensatePressure() in the same order,
+ * divisions by powers of two are replaced by multiplications with the exact reciprocal. The results are
+ * therefore equal bit-for-bit to the scalar functions, as long as the compiler doesn't contract multiplications
+ * and additions into fused multiply-adds (GCC does so with -mfma unless -ffp-contract=off is given).
+ */
+
+#ifndef BMP280_BATCH_HPP
+#define BMP280_BATCH_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Compensate arrays of raw readings using double precision.
+ *
+ * Element i of the outputs is compensateTemperature() and compensatePressure() of element i of the inputs,
+ * the pressure using the t_fine of the temperature with the same index.
+ * @param calibration The calibration data of the sensor.
+ * @param raw_temp The raw 20-bit temperature readings.
+ * @param raw_press The raw 20-bit pressure readings.
+ * @param count The number of readings.
+ * @param temperature Receives the temperatures in degrees Celsius.
+ * @param pressure Receives the pressures in Pa.
+ */
+void compensateBatch(const bmp280_calibration_data& calibration, const uint32_t* raw_temp, const uint32_t* raw_press,
+                     size_t count, double* temperature, double* pressure);
+
+/**
+ * @brief Get the instruction set used by compensateBatch().
+ * @return "AVX", "SSE2" or "scalar".
+ */
+const char* compensateBatchInstructionSet();
+
+#endif // BMP280_BATCH_HPP
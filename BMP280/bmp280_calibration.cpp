@@ -0,0 +1,73 @@
+#include "bmp280_calibration.hpp"
+
+uint16_t bmp280Crc16(const uint8_t* data, int data_size, uint16_t crc) {
+    for (int i = 0; i < data_size; i++) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void decodeCalibration(const uint8_t registers[BMP280_CALIBRATION_LENGTH], bmp280_calibration_data& calibration) {
+    calibration.dig_T1 = static_cast<uint16_t>(registers[0] | (registers[1] << 8));
+    calibration.dig_T2 = static_cast<int16_t>(registers[2] | (registers[3] << 8));
+    calibration.dig_T3 = static_cast<int16_t>(registers[4] | (registers[5] << 8));
+    calibration.dig_P1 = static_cast<uint16_t>(registers[6] | (registers[7] << 8));
+    calibration.dig_P2 = static_cast<int16_t>(registers[8] | (registers[9] << 8));
+    calibration.dig_P3 = static_cast<int16_t>(registers[10] | (registers[11] << 8));
+    calibration.dig_P4 = static_cast<int16_t>(registers[12] | (registers[13] << 8));
+    calibration.dig_P5 = static_cast<int16_t>(registers[14] | (registers[15] << 8));
+    calibration.dig_P6 = static_cast<int16_t>(registers[16] | (registers[17] << 8));
+    calibration.dig_P7 = static_cast<int16_t>(registers[18] | (registers[19] << 8));
+    calibration.dig_P8 = static_cast<int16_t>(registers[20] | (registers[21] << 8));
+    calibration.dig_P9 = static_cast<int16_t>(registers[22] | (registers[23] << 8));
+}
+
+void decodeHumidityCalibration(uint8_t h1, const uint8_t registers[BME280_HUMIDITY_CALIBRATION_LENGTH],
+                               bme280_humidity_calibration& calibration) {
+    calibration.dig_H1 = h1;
+    calibration.dig_H2 = static_cast<int16_t>(registers[0] | (registers[1] << 8));
+    calibration.dig_H3 = registers[2];
+    // The high 8 bits are signed, the low 4 bits are packed into 0xE5
+    calibration.dig_H4 = static_cast<int16_t>(static_cast<int8_t>(registers[3]) * 16 | (registers[4] & 0x0F));
+    calibration.dig_H5 = static_cast<int16_t>(static_cast<int8_t>(registers[5]) * 16 | (registers[4] >> 4));
+    calibration.dig_H6 = static_cast<int8_t>(registers[6]);
+}
+
+void serializeCalibration(const bmp280_calibration_data& calibration, bmp280_calibration_blob& blob) {
+    // Same layout as the registers 0x88..0x9F
+    const uint16_t coefficients[12] = {
+        calibration.dig_T1,
+        static_cast<uint16_t>(calibration.dig_T2),
+        static_cast<uint16_t>(calibration.dig_T3),
+        calibration.dig_P1,
+        static_cast<uint16_t>(calibration.dig_P2),
+        static_cast<uint16_t>(calibration.dig_P3),
+        static_cast<uint16_t>(calibration.dig_P4),
+        static_cast<uint16_t>(calibration.dig_P5),
+        static_cast<uint16_t>(calibration.dig_P6),
+        static_cast<uint16_t>(calibration.dig_P7),
+        static_cast<uint16_t>(calibration.dig_P8),
+        static_cast<uint16_t>(calibration.dig_P9)
+    };
+    for (int i = 0; i < 12; i++) {
+        blob.data[2 * i] = static_cast<uint8_t>(coefficients[i] & 0xFF);
+        blob.data[2 * i + 1] = static_cast<uint8_t>(coefficients[i] >> 8);
+    }
+
+    uint16_t crc = bmp280Crc16(blob.data, BMP280_CALIBRATION_LENGTH);
+    blob.data[BMP280_CALIBRATION_LENGTH] = static_cast<uint8_t>(crc & 0xFF);
+    blob.data[BMP280_CALIBRATION_LENGTH + 1] = static_cast<uint8_t>(crc >> 8);
+}
+
+bool deserializeCalibration(const bmp280_calibration_blob& blob, bmp280_calibration_data& calibration) {
+    uint16_t crc = static_cast<uint16_t>(blob.data[BMP280_CALIBRATION_LENGTH] | (blob.data[BMP280_CALIBRATION_LENGTH + 1] << 8));
+    if (bmp280Crc16(blob.data, BMP280_CALIBRATION_LENGTH) != crc) {
+        return false;
+    }
+
+    decodeCalibration(blob.data, calibration);
+    return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file bmp280_calibration.hpp
+ * @brief Functions to decode, serialize and check the BMP280 calibration data.
+ *
+ * The calibration data never changes for a given sensor, so it can be read once, stored as a
+ * bmp280_calibration_blob and injected at the next boot instead of being read from the NVM again.
+ */
+
+#ifndef BMP280_CALIBRATION_HPP
+#define BMP280_CALIBRATION_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Calculate the CRC-16/CCITT (polynomial 0x1021) of a buffer.
+ * @param data The bytes to calculate the CRC of.
+ * @param data_size The number of bytes.
+ * @param crc The initial value, pass the result of a previous call to continue a CRC over several buffers.
+ * @return The CRC.
+ */
+uint16_t bmp280Crc16(const uint8_t* data, int data_size, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Decode the calibration registers into calibration data.
+ *
+ * All coefficients are stored low byte first, see Chapter 3.11.2 of the datasheet.
+ * @param registers The values of the registers 0x88..0x9F.
+ * @param calibration Receives the calibration coefficients, t_fine is left untouched.
+ */
+void decodeCalibration(const uint8_t registers[BMP280_CALIBRATION_LENGTH], bmp280_calibration_data& calibration);
+
+/**
+ * @brief Decode the humidity calibration registers of a BME280.
+ *
+ * H4 and H5 are 12-bit values that share the register 0xE5, see Chapter 4.2.2 of the BME280 datasheet.
+ * @param h1 The value of the register 0xA1.
+ * @param registers The values of the registers 0xE1..0xE7.
+ * @param calibration Receives the humidity calibration coefficients.
+ */
+void decodeHumidityCalibration(uint8_t h1, const uint8_t registers[BME280_HUMIDITY_CALIBRATION_LENGTH],
+                               bme280_humidity_calibration& calibration);
+
+/**
+ * @brief Serialize calibration data into a CRC protected blob.
+ * @param calibration The calibration data.
+ * @param blob Receives the calibration registers and their CRC.
+ */
+void serializeCalibration(const bmp280_calibration_data& calibration, bmp280_calibration_blob& blob);
+
+/**
+ * @brief Deserialize a blob into calibration data.
+ * @param blob The blob, as written by serializeCalibration().
+ * @param calibration Receives the calibration coefficients, only if the CRC is correct.
+ * @return True if the CRC is correct and the calibration data was set.
+ */
+bool deserializeCalibration(const bmp280_calibration_blob& blob, bmp280_calibration_data& calibration);
+
+#endif // BMP280_CALIBRATION_HPP
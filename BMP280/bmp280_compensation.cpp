@@ -0,0 +1,121 @@
+#include "bmp280_compensation.hpp"
+
+/**
+*   The algorithms for calculating the actual temp and pressure were created by Bosch and implemented by wovo.
+*   The double versions were taken from Bas van den Bergh: https://github.com/BasvandenBergh/IPASS_jaar1_BAS
+**/
+
+// Compensates the raw temperature reading, see Chapter 8.1 of the datasheet
+double compensateTemperature(const bmp280_calibration_data& calibration, uint32_t raw_temp, int32_t& t_fine) {
+    double var1, var2, T;
+    var1 = (((double)raw_temp) / 16384.0 - ((double)calibration.dig_T1) / 1024.0) * ((double)calibration.dig_T2);
+    var2 = ((((double)raw_temp) / 131072.0 - ((double)calibration.dig_T1) / 8192.0) * (((double)raw_temp) / 131072.0 - ((double)calibration.dig_T1) / 8192.0)) * ((double)calibration.dig_T3);
+    t_fine = (int32_t)(var1 + var2);
+    T = (var1 + var2) / 5120.0;
+    return T;
+}
+
+// Compensates the raw pressure reading, see Chapter 8.1 of the datasheet
+double compensatePressure(const bmp280_calibration_data& calibration, uint32_t raw_press, int32_t t_fine) {
+    double var1, var2, p;
+    var1 = ((double)t_fine/2.0) - 64000.0;
+    var2 = var1 * var1 * ((double)calibration.dig_P6) / 32768.0;
+    var2 = var2 + var1 * ((double)calibration.dig_P5) * 2.0;
+    var2 = (var2/4.0) + (((double)calibration.dig_P4) * 65536.0);
+    var1 = (((double)calibration.dig_P3) * var1 * var1 / 524288.0 + ((double)calibration.dig_P2) * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * ((double)calibration.dig_P1);
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576.0 - (double)raw_press;
+    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = ((double)calibration.dig_P9) * p * p / 2147483648.0;
+    var2 = p * ((double)calibration.dig_P8) / 32768.0;
+    p = p + (var1 + var2 + ((double)calibration.dig_P7)) / 16.0;
+    return p;
+}
+
+// Compensates the raw temperature reading with 32-bit integers, see Chapter 3.11.3 of the datasheet
+int32_t compensateTemperatureInt(const bmp280_calibration_data& calibration, uint32_t raw_temp, int32_t& t_fine) {
+    int32_t adc_T = static_cast<int32_t>(raw_temp);
+    int32_t var1, var2;
+    var1 = ((((adc_T >> 3) - ((int32_t)calibration.dig_T1 << 1))) * ((int32_t)calibration.dig_T2)) >> 11;
+    var2 = (((((adc_T >> 4) - ((int32_t)calibration.dig_T1)) * ((adc_T >> 4) - ((int32_t)calibration.dig_T1))) >> 12) * ((int32_t)calibration.dig_T3)) >> 14;
+    t_fine = var1 + var2;
+    return (t_fine * 5 + 128) >> 8;
+}
+
+// Compensates the raw pressure reading with 64-bit integers, see Chapter 3.11.3 of the datasheet
+uint32_t compensatePressureInt(const bmp280_calibration_data& calibration, uint32_t raw_press, int32_t t_fine) {
+    int64_t var1, var2, p;
+    var1 = ((int64_t)t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t)calibration.dig_P6;
+    var2 = var2 + ((var1 * (int64_t)calibration.dig_P5) << 17);
+    var2 = var2 + (((int64_t)calibration.dig_P4) << 35);
+    var1 = ((var1 * var1 * (int64_t)calibration.dig_P3) >> 8) + ((var1 * (int64_t)calibration.dig_P2) << 12);
+    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calibration.dig_P1) >> 33;
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576 - (int64_t)raw_press;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)calibration.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t)calibration.dig_P8) * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (((int64_t)calibration.dig_P7) << 4);
+    return (uint32_t)p;
+}
+
+// Compensates the raw humidity reading of a BME280 with 32-bit integers, see Chapter 4.2.3 of the BME280 datasheet
+uint32_t compensateHumidityInt(const bme280_humidity_calibration& calibration, uint32_t raw_hum, int32_t t_fine) {
+    int32_t adc_H = static_cast<int32_t>(raw_hum);
+    int32_t v_x1;
+    v_x1 = t_fine - ((int32_t)76800);
+    v_x1 = (((((adc_H << 14) - (((int32_t)calibration.dig_H4) << 20) - (((int32_t)calibration.dig_H5) * v_x1)) + ((int32_t)16384)) >> 15)
+         * (((((((v_x1 * ((int32_t)calibration.dig_H6)) >> 10) * (((v_x1 * ((int32_t)calibration.dig_H3)) >> 11) + ((int32_t)32768))) >> 10)
+         + ((int32_t)2097152)) * ((int32_t)calibration.dig_H2) + 8192) >> 14));
+    v_x1 = (v_x1 - (((((v_x1 >> 15) * (v_x1 >> 15)) >> 7) * ((int32_t)calibration.dig_H1)) >> 4));
+    v_x1 = (v_x1 < 0 ? 0 : v_x1);
+    v_x1 = (v_x1 > 419430400 ? 419430400 : v_x1);
+    return (uint32_t)(v_x1 >> 12);
+}
+
+// Every constant below is a power of two, so the pre-scaling itself adds no rounding in double precision
+void buildCompensationPlan(const bmp280_calibration_data& calibration, bmp280_compensation_plan& plan) {
+    // var1 = d * T2 / 2^14 and var2 = d^2 * T3 / 2^34, with d = raw_temp - 16 * T1
+    plan.t_offset = 16 * static_cast<int32_t>(calibration.dig_T1);
+    plan.t_linear = static_cast<float>(calibration.dig_T2 / 16384.0);
+    plan.t_square = static_cast<float>(calibration.dig_T3 / 17179869184.0);
+
+    // var2 / 4096 = v^2 * P6 / 2^29 + v * P5 / 2^13 + P4 * 16
+    plan.p_offset0 = static_cast<float>(calibration.dig_P4 * 16.0);
+    plan.p_offset1 = static_cast<float>(calibration.dig_P5 / 8192.0);
+    plan.p_offset2 = static_cast<float>(calibration.dig_P6 / 536870912.0);
+
+    // var1 = P1 + v * P1 * P2 / 2^34 + v^2 * P1 * P3 / 2^53, divided by 6250 to fold in the final scale
+    plan.p_scale0 = static_cast<float>(calibration.dig_P1 / 6250.0);
+    plan.p_scale1 = static_cast<float>(static_cast<double>(calibration.dig_P1) * calibration.dig_P2 / 17179869184.0 / 6250.0);
+    plan.p_scale2 = static_cast<float>(static_cast<double>(calibration.dig_P1) * calibration.dig_P3 / 9007199254740992.0 / 6250.0);
+
+    // p + (p^2 * P9 / 2^31 + p * P8 / 2^15 + P7) / 16
+    plan.p_out0 = static_cast<float>(calibration.dig_P7 / 16.0);
+    plan.p_out1 = static_cast<float>(1.0 + calibration.dig_P8 / 524288.0);
+    plan.p_out2 = static_cast<float>(calibration.dig_P9 / 34359738368.0);
+}
+
+float compensateTemperature(const bmp280_compensation_plan& plan, uint32_t raw_temp, int32_t& t_fine) {
+    float d = static_cast<float>(static_cast<int32_t>(raw_temp) - plan.t_offset);
+    float fine = d * (plan.t_linear + d * plan.t_square);
+    t_fine = static_cast<int32_t>(fine);
+    return fine * (1.0f / 5120.0f);
+}
+
+float compensatePressure(const bmp280_compensation_plan& plan, uint32_t raw_press, int32_t t_fine) {
+    float v = static_cast<float>(t_fine) * 0.5f - 64000.0f;
+    float scale = plan.p_scale0 + v * (plan.p_scale1 + v * plan.p_scale2);
+    if (scale == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    float offset = plan.p_offset0 + v * (plan.p_offset1 + v * plan.p_offset2);
+    float p = (static_cast<float>(1048576 - static_cast<int32_t>(raw_press)) - offset) / scale;
+    return plan.p_out0 + p * (plan.p_out1 + p * plan.p_out2);
+}
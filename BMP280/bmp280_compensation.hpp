@@ -0,0 +1,126 @@
+/**
+ * @file bmp280_compensation.hpp
+ * @brief Compensation formulas that turn raw BMP280 readings into temperature and pressure.
+ *
+ * The double precision formulas are the ones from Chapter 8.1 of the datasheet. The integer formulas
+ * are the 32-bit temperature and 64-bit pressure formulas from Chapter 3.11.3 of the datasheet, they
+ * need no floating point support at all and are the preferred path on targets without an FPU.
+ *
+ * The functions only use the calibration data, so raw readings can also be compensated away from the sensor.
+ *
+ * The compensation plan rewrites the double precision formulas once per sensor, with every division by a
+ * constant folded into the coefficients. What remains per sample is a few float multiply-adds and a single
+ * division for the pressure.
+ */
+
+#ifndef BMP280_COMPENSATION_HPP
+#define BMP280_COMPENSATION_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Compensate a raw temperature reading using double precision.
+ * @param calibration The calibration data of the sensor.
+ * @param raw_temp The raw 20-bit temperature reading.
+ * @param t_fine Receives the fine temperature needed to compensate the pressure of the same conversion.
+ * @return The temperature in degrees Celsius.
+ */
+double compensateTemperature(const bmp280_calibration_data& calibration, uint32_t raw_temp, int32_t& t_fine);
+
+/**
+ * @brief Compensate a raw pressure reading using double precision.
+ * @param calibration The calibration data of the sensor.
+ * @param raw_press The raw 20-bit pressure reading.
+ * @param t_fine The fine temperature of the same conversion.
+ * @return The pressure in Pa.
+ */
+double compensatePressure(const bmp280_calibration_data& calibration, uint32_t raw_press, int32_t t_fine);
+
+/**
+ * @brief Compensate a raw temperature reading using 32-bit integer arithmetic.
+ * @param calibration The calibration data of the sensor.
+ * @param raw_temp The raw 20-bit temperature reading.
+ * @param t_fine Receives the fine temperature needed to compensate the pressure of the same conversion.
+ * @return The temperature in 0.01 degrees Celsius, 5123 equals 51.23 degrees Celsius.
+ */
+int32_t compensateTemperatureInt(const bmp280_calibration_data& calibration, uint32_t raw_temp, int32_t& t_fine);
+
+/**
+ * @brief Compensate a raw pressure reading using 64-bit integer arithmetic.
+ * @param calibration The calibration data of the sensor.
+ * @param raw_press The raw 20-bit pressure reading.
+ * @param t_fine The fine temperature of the same conversion.
+ * @return The pressure in Pa as Q24.8 fixed point, 24674867 equals 24674867 / 256 = 96386.2 Pa.
+ */
+uint32_t compensatePressureInt(const bmp280_calibration_data& calibration, uint32_t raw_press, int32_t t_fine);
+
+/**
+ * @brief Compensate a raw humidity reading of a BME280 using 32-bit integer arithmetic.
+ *
+ * This is the formula of Chapter 4.2.3 of the BME280 datasheet. The humidity depends on the temperature,
+ * so compensate the temperature of the same conversion first.
+ * @param calibration The humidity calibration data of the sensor.
+ * @param raw_hum The raw 16-bit humidity reading.
+ * @param t_fine The fine temperature of the same conversion.
+ * @return The relative humidity in % as Q22.10 fixed point, between 0 and 100 %.
+ */
+uint32_t compensateHumidityInt(const bme280_humidity_calibration& calibration, uint32_t raw_hum, int32_t t_fine);
+
+/**
+ * @struct bmp280_compensation_plan
+ * @brief Struct that holds the calibration coefficients of a sensor, pre-scaled for float compensation.
+ *
+ * With d = raw_temp - 16 * dig_T1 the formulas of Chapter 8.1 of the datasheet reduce to
+ * t_fine = d * (t_linear + d * t_square). With v = t_fine / 2 - 64000 and x = 1048576 - raw_press the pressure is
+ * p = (x - (p_offset0 + v * (p_offset1 + v * p_offset2))) / (p_scale0 + v * (p_scale1 + v * p_scale2)),
+ * followed by the correction p_out0 + p * (p_out1 + p * p_out2).
+ */
+typedef struct {
+    int32_t t_offset;  /**< 16 * dig_T1 */
+    float t_linear;    /**< dig_T2 / 2^14 */
+    float t_square;    /**< dig_T3 / 2^34 */
+    float p_offset0;   /**< Constant term of var2 / 4096 */
+    float p_offset1;   /**< Linear term of var2 / 4096 */
+    float p_offset2;   /**< Square term of var2 / 4096 */
+    float p_scale0;    /**< Constant term of var1 / 6250 */
+    float p_scale1;    /**< Linear term of var1 / 6250 */
+    float p_scale2;    /**< Square term of var1 / 6250 */
+    float p_out0;      /**< Constant term of the final correction */
+    float p_out1;      /**< Linear term of the final correction */
+    float p_out2;      /**< Square term of the final correction */
+} bmp280_compensation_plan;
+
+/**
+ * @brief Build the compensation plan of a sensor.
+ * @param calibration The calibration data of the sensor.
+ * @param plan Receives the pre-scaled coefficients.
+ */
+void buildCompensationPlan(const bmp280_calibration_data& calibration, bmp280_compensation_plan& plan);
+
+/**
+ * @brief Compensate a raw temperature reading using a compensation plan.
+ *
+ * For the example calibration of the datasheet the result stays within 0.001 degrees Celsius of
+ * compensateTemperature() from -40 to 85 degrees Celsius. t_fine may differ by 1 when the double result lies
+ * close to an integer.
+ * @param plan The compensation plan of the sensor.
+ * @param raw_temp The raw 20-bit temperature reading.
+ * @param t_fine Receives the fine temperature needed to compensate the pressure of the same conversion.
+ * @return The temperature in degrees Celsius.
+ */
+float compensateTemperature(const bmp280_compensation_plan& plan, uint32_t raw_temp, int32_t& t_fine);
+
+/**
+ * @brief Compensate a raw pressure reading using a compensation plan.
+ *
+ * For the example calibration of the datasheet the result stays within 0.1 Pa of compensatePressure()
+ * from 300 to 1100 hPa and -40 to 85 degrees Celsius.
+ * @param plan The compensation plan of the sensor.
+ * @param raw_press The raw 20-bit pressure reading.
+ * @param t_fine The fine temperature of the same conversion.
+ * @return The pressure in Pa.
+ */
+float compensatePressure(const bmp280_compensation_plan& plan, uint32_t raw_press, int32_t t_fine);
+
+#endif // BMP280_COMPENSATION_HPP
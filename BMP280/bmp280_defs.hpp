@@ -66,8 +66,8 @@ enum standby_config : uint8_t {
     STANDBY_MS_250 = 0x03,   /**< Standby time 250 ms */
     STANDBY_MS_500 = 0x04,   /**< Standby time 500 ms */
     STANDBY_MS_1000 = 0x05,  /**< Standby time 1000 ms */
-    STANDBY_MS_2000 = 0x06,  /**< Standby time 2000 ms */
-    STANDBY_MS_4000 = 0x07   /**< Standby time 4000 ms */
+    STANDBY_MS_2000 = 0x06,  /**< Standby time 2000 ms, 10 ms on a BME280 */
+    STANDBY_MS_4000 = 0x07   /**< Standby time 4000 ms, 20 ms on a BME280 */
 };
 
 /**
@@ -103,6 +103,155 @@ constexpr uint8_t BMP280_CONFIG_REG = 0xF5;
 constexpr uint8_t BMP280_PRESS_DATA_REG = 0xF7;
 constexpr uint8_t BMP280_TEMP_DATA_REG = 0xFA;
 
+/**
+ * @brief Values of the chip ID register.
+ *
+ * The BME280 is pin and register compatible with the BMP280 and adds a humidity sensor, see Chapter 5.4.1 of the
+ * BME280 datasheet.
+ */
+constexpr uint8_t BMP280_CHIP_ID = 0x58;
+constexpr uint8_t BME280_CHIP_ID = 0x60;
+
+/**
+ * @brief Register addresses of the BME280 only.
+ *
+ * The humidity calibration data is split over 0xA1 and 0xE1..0xE7, see Chapter 4.2.2 of the BME280 datasheet.
+ * The humidity data follows the temperature data, so all three values can be read in one burst (Chapter 5.4.9).
+ */
+constexpr uint8_t BME280_DIG_H1_REG = 0xA1;
+constexpr uint8_t BME280_DIG_H2_REG = 0xE1;
+constexpr uint8_t BME280_CTRL_HUM_REG = 0xF2;
+constexpr uint8_t BME280_HUM_DATA_REG = 0xFD;
+
+/**
+ * @brief Bits of the status register.
+ *
+ * The bits are specified in Chapter 4.3.3 of the datasheet.
+ */
+constexpr uint8_t BMP280_STATUS_MEASURING = 0x08; /**< Set while a conversion is running */
+constexpr uint8_t BMP280_STATUS_IM_UPDATE = 0x01; /**< Set while the calibration data is copied from the NVM */
+
+/**
+ * @brief Get the number of samples taken for an oversampling setting.
+ * @param osrs The oversampling setting.
+ * @return The number of samples, 0 if the measurement is skipped.
+ */
+constexpr uint8_t oversamplingFactor(sampling_config osrs) {
+    return osrs == SAMPLING_NONE ? 0 : static_cast<uint8_t>(1 << (osrs - 1));
+}
+
+/**
+ * @brief Get the maximum duration of a single conversion.
+ *
+ * Uses the maximum measurement time formula from Chapter 3.8.1 of the datasheet:
+ * 1.25 ms + 2.3 ms per temperature sample + (2.3 ms per pressure sample + 0.575 ms).
+ * The humidity of a BME280 adds the same as the pressure, see Chapter 9.1 of the BME280 datasheet.
+ * @param osrs_t The oversampling setting for temperature.
+ * @param osrs_p The oversampling setting for pressure.
+ * @param osrs_h The oversampling setting for humidity, only on a BME280.
+ * @return The maximum measurement time in microseconds.
+ */
+constexpr uint32_t measurementTimeUs(sampling_config osrs_t, sampling_config osrs_p, sampling_config osrs_h = SAMPLING_NONE) {
+    return 1250 + 2300 * oversamplingFactor(osrs_t)
+         + (osrs_p == SAMPLING_NONE ? 0 : 2300 * oversamplingFactor(osrs_p) + 575)
+         + (osrs_h == SAMPLING_NONE ? 0 : 2300 * oversamplingFactor(osrs_h) + 575);
+}
+
+/**
+ * @brief Get the typical duration of a single conversion.
+ *
+ * Uses the typical measurement time formula from Chapter 3.8.1 of the datasheet:
+ * 1 ms + 2 ms per temperature sample + (2 ms per pressure sample + 0.5 ms).
+ * The humidity of a BME280 adds the same as the pressure.
+ * @param osrs_t The oversampling setting for temperature.
+ * @param osrs_p The oversampling setting for pressure.
+ * @param osrs_h The oversampling setting for humidity, only on a BME280.
+ * @return The typical measurement time in microseconds.
+ */
+constexpr uint32_t typicalMeasurementTimeUs(sampling_config osrs_t, sampling_config osrs_p, sampling_config osrs_h = SAMPLING_NONE) {
+    return 1000 + 2000 * oversamplingFactor(osrs_t)
+         + (osrs_p == SAMPLING_NONE ? 0 : 2000 * oversamplingFactor(osrs_p) + 500)
+         + (osrs_h == SAMPLING_NONE ? 0 : 2000 * oversamplingFactor(osrs_h) + 500);
+}
+
+/**
+ * @brief Get the standby time between conversions in normal mode.
+ *
+ * The times are specified in Table 11 of the datasheet. Note that STANDBY_MS_1 is actually 0.5 ms.
+ * A BME280 uses the two longest settings for 10 ms and 20 ms instead, see Table 27 of the BME280 datasheet.
+ * @param standby The standby setting.
+ * @param chip_id The value of the chip ID register, BME280_CHIP_ID for a BME280.
+ * @return The standby time in microseconds.
+ */
+constexpr uint32_t standbyTimeUs(standby_config standby, uint8_t chip_id = BMP280_CHIP_ID) {
+    return chip_id == BME280_CHIP_ID && standby == STANDBY_MS_2000 ? 10000
+         : chip_id == BME280_CHIP_ID && standby == STANDBY_MS_4000 ? 20000
+         : standby == STANDBY_MS_1 ? 500 : 62500u << (standby - STANDBY_MS_63);
+}
+
+/**
+ * @brief Compose the value of the ctrl_meas register.
+ *
+ * The layout of the register is specified in Chapter 4.3.4 of the datasheet.
+ * @param osrs_t The oversampling setting for temperature (bits 7:5).
+ * @param osrs_p The oversampling setting for pressure (bits 4:2).
+ * @param mode The power mode (bits 1:0).
+ * @return The value of the ctrl_meas register.
+ */
+constexpr uint8_t makeCtrlMeas(sampling_config osrs_t, sampling_config osrs_p, power_modes mode) {
+    return static_cast<uint8_t>((osrs_t << 5) | (osrs_p << 2) | mode);
+}
+
+/**
+ * @brief Compose the value of the config register.
+ *
+ * The layout of the register is specified in Chapter 4.3.5 of the datasheet. SPI 3-wire mode (bit 0) is left disabled.
+ * @param standby The standby time in normal mode (bits 7:5).
+ * @param filter The IIR filter coefficient (bits 4:2).
+ * @return The value of the config register.
+ */
+constexpr uint8_t makeConfig(standby_config standby, filter_config filter) {
+    return static_cast<uint8_t>((standby << 5) | (filter << 2));
+}
+
+/**
+ * @brief Number of data registers read in a single burst.
+ *
+ * The pressure and temperature data registers (0xF7..0xFC) are read in one burst, so both values
+ * belong to the same conversion. See Chapter 3.9 of the datasheet.
+ */
+constexpr uint8_t BMP280_DATA_LENGTH = 6;
+
+/**
+ * @brief Number of data registers of a BME280, the pressure, temperature and humidity (0xF7..0xFE).
+ */
+constexpr uint8_t BME280_DATA_LENGTH = 8;
+
+/**
+ * @brief Raw humidity of a skipped measurement.
+ *
+ * A BME280 reports this value when the humidity is disabled in ctrl_hum, see Chapter 5.4.9 of the BME280 datasheet.
+ * It compensates to a plausible humidity, so it must be checked before compensation.
+ */
+constexpr uint16_t BME280_RAW_HUMIDITY_SKIPPED = 0x8000;
+
+/**
+ * @brief Number of registers in a register snapshot.
+ *
+ * A snapshot covers all registers from the chip ID register (0xD0) up to and including the last data register (0xFC).
+ */
+constexpr uint8_t BMP280_SNAPSHOT_LENGTH = 0xFC - BMP280_CHIP_ID_REG + 1;
+
+/**
+ * @brief Length of the calibration data in the NVM, the registers 0x88..0x9F.
+ */
+constexpr uint8_t BMP280_CALIBRATION_LENGTH = 24;
+
+/**
+ * @brief Length of a serialized calibration blob, the calibration registers followed by a CRC-16.
+ */
+constexpr uint8_t BMP280_CALIBRATION_BLOB_LENGTH = BMP280_CALIBRATION_LENGTH + 2;
+
 /**
  * @struct bmp280_calibration_data
  * @brief Struct that holds calibration data for the BMP280 sensor.
@@ -127,4 +276,93 @@ typedef struct {
     int32_t t_fine;    /**< Fine temperature value for temperature calculation */
 } bmp280_calibration_data;
 
+/**
+ * @brief Length of the humidity calibration data of a BME280 in the registers 0xE1..0xE7.
+ */
+constexpr uint8_t BME280_HUMIDITY_CALIBRATION_LENGTH = 7;
+
+/**
+ * @struct bme280_humidity_calibration
+ * @brief Struct that holds the humidity calibration data of a BME280, see Chapter 4.2.2 of the BME280 datasheet.
+ */
+typedef struct {
+    uint8_t dig_H1;    /**< Humidity calibration coefficient H1 */
+    int16_t dig_H2;    /**< Humidity calibration coefficient H2 */
+    uint8_t dig_H3;    /**< Humidity calibration coefficient H3 */
+    int16_t dig_H4;    /**< Humidity calibration coefficient H4, 12 bits */
+    int16_t dig_H5;    /**< Humidity calibration coefficient H5, 12 bits */
+    int8_t dig_H6;     /**< Humidity calibration coefficient H6 */
+} bme280_humidity_calibration;
+
+/**
+ * @struct bmp280_calibration_blob
+ * @brief Struct that holds the calibration data in a compact, CRC protected form.
+ *
+ * The first 24 bytes are the calibration registers 0x88..0x9F exactly as the sensor stores them
+ * (Chapter 3.11.2 of the datasheet), followed by a CRC-16/CCITT of those bytes, low byte first.
+ * A blob can be stored in flash or EEPROM and passed to the bmp280 constructor to skip reading the NVM at boot.
+ */
+typedef struct {
+    uint8_t data[BMP280_CALIBRATION_BLOB_LENGTH]; /**< Calibration registers and CRC */
+} bmp280_calibration_blob;
+
+/**
+ * @struct bmp280_raw_sample
+ * @brief Struct that holds one raw temperature and pressure reading.
+ *
+ * Both values are the 20-bit ADC outputs of the same conversion.
+ */
+typedef struct {
+    uint32_t temperature; /**< Raw 20-bit temperature reading */
+    uint32_t pressure;    /**< Raw 20-bit pressure reading */
+} bmp280_raw_sample;
+
+/**
+ * @struct bmp280_sample
+ * @brief Struct that holds one compensated temperature and pressure reading.
+ */
+typedef struct {
+    double temperature; /**< Compensated temperature in degrees Celsius */
+    double pressure;    /**< Compensated pressure in Pa */
+} bmp280_sample;
+
+/**
+ * @struct bmp280_sample_int
+ * @brief Struct that holds one compensated temperature and pressure reading in fixed point.
+ */
+typedef struct {
+    int32_t temperature; /**< Compensated temperature in 0.01 degrees Celsius */
+    uint32_t pressure;   /**< Compensated pressure in Pa as Q24.8 fixed point */
+} bmp280_sample_int;
+
+/**
+ * @struct bme280_sample_int
+ * @brief Struct that holds one compensated temperature, pressure and humidity reading of a BME280 in fixed point.
+ */
+typedef struct {
+    int32_t temperature; /**< Compensated temperature in 0.01 degrees Celsius */
+    uint32_t pressure;   /**< Compensated pressure in Pa as Q24.8 fixed point */
+    uint32_t humidity;   /**< Compensated relative humidity in % as Q22.10 fixed point, 0 on a BMP280 or when skipped */
+} bme280_sample_int;
+
+/**
+ * @struct bmp280_register_snapshot
+ * @brief Struct that holds the values of the registers 0xD0..0xFC, read in a single burst.
+ *
+ * The print methods of the bmp280 class decode their output from a snapshot, so diagnostics
+ * only need a single bus transaction pair.
+ */
+struct bmp280_register_snapshot {
+    uint8_t registers[BMP280_SNAPSHOT_LENGTH]; /**< Register values, starting at the chip ID register */
+
+    /**
+     * @brief Get the value of a register in the snapshot.
+     * @param reg The register address, between 0xD0 and 0xFC.
+     * @return The value of the register when the snapshot was taken.
+     */
+    uint8_t get(uint8_t reg) const {
+        return registers[reg - BMP280_CHIP_ID_REG];
+    }
+};
+
 #endif // BMP280_DEFS_HPP
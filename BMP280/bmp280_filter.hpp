@@ -0,0 +1,418 @@
+/**
+ * @file bmp280_filter.hpp
+ * @brief Fixed-point software filters that are chained at compile time.
+ *
+ * The on-chip IIR filter smooths the data before it is read, but it can't reject spikes or lower the sample rate.
+ * The stages below work on the compensated integer values of bmp280_sample_int, use no floating point math
+ * and no heap, and are chained with bmp280_filter_chain:
+ *
+ * @code
+ * // Reject single glitches, smooth a little, then average 128 samples into one
+ * typedef bmp280_filter_chain<bmp280_median_filter<3>, bmp280_iir_filter<1>, bmp280_cic_decimator<128, 2>> chain;
+ * bmp280_sample_filter<chain> filter;
+ *
+ * bmp280_sample_int output;
+ * if (filter.push(sensor.readSampleInt(), output)) {
+ *     // One output per 128 samples
+ * }
+ * @endcode
+ *
+ * Every stage has push(), which returns true when it produced an output, reset(), and a decimation constant that
+ * tells how many inputs it takes per output.
+ */
+
+#ifndef BMP280_FILTER_HPP
+#define BMP280_FILTER_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Divide and round to the nearest integer, halfway cases away from zero.
+ * @param value The value to divide.
+ * @param divisor The divisor, larger than 0.
+ * @return The rounded quotient.
+ */
+constexpr int64_t bmp280RoundedDivide(int64_t value, int64_t divisor) {
+    return value >= 0 ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+}
+
+/**
+ * @class bmp280_median_filter
+ * @brief Running median over the last samples, removes spikes shorter than half the window.
+ *
+ * The window is kept sorted, so a new sample costs one pass over the window. Until the window is full, the
+ * median of the samples received so far is returned.
+ * @tparam window The number of samples, odd so the median is one of them.
+ **/
+template<int window>
+class bmp280_median_filter {
+
+    static_assert(window >= 3 && window % 2 == 1, "the window of a median filter must be odd and at least 3");
+
+private:
+    int32_t history[window]; /**< The samples in the order they arrived, used as a ring */
+    int32_t sorted[window];  /**< The same samples, sorted */
+    int count = 0;           /**< Number of samples in the window */
+    int oldest = 0;          /**< Index in history of the oldest sample */
+
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = 1;
+
+    /**
+     * @brief Add a sample.
+     * @param input The sample.
+     * @param output Receives the median of the window.
+     * @return Always true.
+     */
+    bool push(int32_t input, int32_t& output) {
+        int position;
+        if (count == window) {
+            // Remove the oldest sample, its place becomes the gap the new one is inserted into
+            int32_t removed = history[oldest];
+            position = 0;
+            while (sorted[position] != removed) {
+                position++;
+            }
+            history[oldest] = input;
+            oldest = (oldest + 1) % window;
+        } else {
+            history[count] = input;
+            position = count++;
+        }
+
+        // Move the gap to where the new sample belongs
+        while (position > 0 && sorted[position - 1] > input) {
+            sorted[position] = sorted[position - 1];
+            position--;
+        }
+        while (position < count - 1 && sorted[position + 1] < input) {
+            sorted[position] = sorted[position + 1];
+            position++;
+        }
+        sorted[position] = input;
+
+        output = sorted[count / 2];
+        return true;
+    }
+
+    /**
+     * @brief Empty the window.
+     */
+    void reset() {
+        count = 0;
+        oldest = 0;
+    }
+};
+
+/**
+ * @class bmp280_iir_filter
+ * @brief First order low-pass filter: y += (x - y) / 2^shift.
+ *
+ * This is the same filter as the on-chip one of Chapter 3.3.3 of the datasheet with coefficient 2^shift, but it
+ * runs after the spike rejection. The state has 16 fractional bits, so small steps aren't lost to rounding.
+ * The first sample sets the state, so the output doesn't start at 0.
+ * @tparam shift log2 of the filter coefficient.
+ **/
+template<int shift>
+class bmp280_iir_filter {
+
+    static_assert(shift >= 1 && shift <= 15, "the shift of an IIR filter must be between 1 and 15");
+
+private:
+    int64_t state = 0;   /**< The output with 16 fractional bits */
+    bool primed = false; /**< False until the first sample */
+
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = 1;
+
+    /**
+     * @brief Add a sample.
+     * @param input The sample.
+     * @param output Receives the filtered value.
+     * @return Always true.
+     */
+    bool push(int32_t input, int32_t& output) {
+        int64_t scaled = static_cast<int64_t>(input) * 65536;
+        if (!primed) {
+            state = scaled;
+            primed = true;
+        } else {
+            state += (scaled - state) / (1 << shift);
+        }
+        output = static_cast<int32_t>(bmp280RoundedDivide(state, 65536));
+        return true;
+    }
+
+    /**
+     * @brief Forget the state, the next sample sets it again.
+     */
+    void reset() {
+        primed = false;
+    }
+};
+
+/**
+ * @class bmp280_boxcar_decimator
+ * @brief Outputs the mean of every group of factor samples.
+ * @tparam factor The number of inputs per output.
+ **/
+template<uint32_t factor>
+class bmp280_boxcar_decimator {
+
+    static_assert(factor >= 1 && factor <= 65536, "the factor of a boxcar decimator must be between 1 and 65536");
+
+private:
+    int64_t sum = 0;     /**< Sum of the samples of the current group */
+    uint32_t count = 0;  /**< Number of samples in the current group */
+
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = factor;
+
+    /**
+     * @brief Add a sample.
+     * @param input The sample.
+     * @param output Receives the mean of the group when it is complete.
+     * @return True if the group is complete.
+     */
+    bool push(int32_t input, int32_t& output) {
+        sum += input;
+        if (++count < factor) {
+            return false;
+        }
+        output = static_cast<int32_t>(bmp280RoundedDivide(sum, factor));
+        sum = 0;
+        count = 0;
+        return true;
+    }
+
+    /**
+     * @brief Drop the current group.
+     */
+    void reset() {
+        sum = 0;
+        count = 0;
+    }
+};
+
+/**
+ * @brief Calculate a power at compile time.
+ * @param base The base.
+ * @param exponent The exponent.
+ * @return base to the power exponent.
+ */
+constexpr uint64_t bmp280Power(uint64_t base, int exponent) {
+    return exponent == 0 ? 1 : base * bmp280Power(base, exponent - 1);
+}
+
+/**
+ * @class bmp280_cic_decimator
+ * @brief Cascaded integrator-comb decimator, a stack of boxcar filters without any multiplications.
+ *
+ * A CIC of order N is N boxcar filters of length factor in a row, computed with N integrators at the input rate
+ * and N combs at the output rate. It suppresses the frequencies that would alias into the output much better than
+ * a single boxcar. The integrators are allowed to overflow: with modular arithmetic the output is still exact, as
+ * long as the gain factor^order fits in the 32 bits left above the input.
+ *
+ * The first order - 1 outputs are dropped, because they still include the zeros the filter started with.
+ * @tparam factor The number of inputs per output.
+ * @tparam order The number of stages.
+ **/
+template<uint32_t factor, int order>
+class bmp280_cic_decimator {
+
+    static_assert(factor >= 2, "the factor of a CIC decimator must be at least 2");
+    static_assert(order >= 1 && order <= 4, "the order of a CIC decimator must be between 1 and 4");
+    static_assert(bmp280Power(factor, order) <= 0xFFFFFFFFull, "the gain of the CIC decimator doesn't fit in 32 bits");
+
+private:
+    static constexpr int64_t gain = static_cast<int64_t>(bmp280Power(factor, order)); /**< DC gain */
+
+    uint64_t integrators[order] = {}; /**< Integrator states, wrapping around */
+    uint64_t delays[order] = {};      /**< Previous input of every comb */
+    uint32_t count = 0;               /**< Number of inputs since the last output */
+    int settled = 0;                  /**< Number of outputs produced, up to order */
+
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = factor;
+
+    /**
+     * @brief Add a sample.
+     * @param input The sample.
+     * @param output Receives the filtered value, scaled back to the input.
+     * @return True if an output was produced.
+     */
+    bool push(int32_t input, int32_t& output) {
+        uint64_t value = static_cast<uint64_t>(static_cast<int64_t>(input));
+        for (int i = 0; i < order; i++) {
+            integrators[i] += value;
+            value = integrators[i];
+        }
+        if (++count < factor) {
+            return false;
+        }
+        count = 0;
+
+        for (int i = 0; i < order; i++) {
+            uint64_t difference = value - delays[i];
+            delays[i] = value;
+            value = difference;
+        }
+        if (settled < order - 1) {
+            settled++;
+            return false;
+        }
+        output = static_cast<int32_t>(bmp280RoundedDivide(static_cast<int64_t>(value), gain));
+        return true;
+    }
+
+    /**
+     * @brief Clear the integrators and combs, the next outputs are dropped until the filter is settled.
+     */
+    void reset() {
+        for (int i = 0; i < order; i++) {
+            integrators[i] = 0;
+            delays[i] = 0;
+        }
+        count = 0;
+        settled = 0;
+    }
+};
+
+/**
+ * @class bmp280_filter_chain
+ * @brief Stages that are applied one after another, itself usable as a stage.
+ *
+ * A sample stops at the first stage that produces no output.
+ * @tparam stages The stages, in the order they are applied.
+ **/
+template<typename... stages>
+class bmp280_filter_chain;
+
+/**
+ * @class bmp280_filter_chain<>
+ * @brief The end of a chain, passes samples through.
+ **/
+template<>
+class bmp280_filter_chain<> {
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = 1;
+
+    /**
+     * @brief Pass a sample through.
+     * @param input The sample.
+     * @param output Receives the sample.
+     * @return Always true.
+     */
+    bool push(int32_t input, int32_t& output) {
+        output = input;
+        return true;
+    }
+
+    /**
+     * @brief Nothing to reset.
+     */
+    void reset() {}
+};
+
+template<typename first, typename... rest>
+class bmp280_filter_chain<first, rest...> {
+
+private:
+    first stage;                      /**< The first stage */
+    bmp280_filter_chain<rest...> next; /**< The stages after it */
+
+public:
+    /**
+     * @brief Number of inputs per output of the whole chain.
+     */
+    static constexpr uint32_t decimation = first::decimation * bmp280_filter_chain<rest...>::decimation;
+
+    /**
+     * @brief Pass a sample through the stages.
+     * @param input The sample.
+     * @param output Receives the output of the last stage.
+     * @return True if the last stage produced an output.
+     */
+    bool push(int32_t input, int32_t& output) {
+        int32_t value;
+        return stage.push(input, value) && next.push(value, output);
+    }
+
+    /**
+     * @brief Reset all stages.
+     */
+    void reset() {
+        stage.reset();
+        next.reset();
+    }
+};
+
+/**
+ * @class bmp280_sample_filter
+ * @brief Filters the temperature and pressure of compensated samples.
+ * @tparam temperature_chain The stages for the temperature.
+ * @tparam pressure_chain The stages for the pressure, the same as for the temperature by default.
+ **/
+template<typename temperature_chain, typename pressure_chain = temperature_chain>
+class bmp280_sample_filter {
+
+    static_assert(temperature_chain::decimation == pressure_chain::decimation,
+                  "both chains must produce their outputs at the same time");
+
+private:
+    temperature_chain temperature; /**< Stages for the temperature */
+    pressure_chain pressure;       /**< Stages for the pressure */
+
+public:
+    /**
+     * @brief Number of inputs per output.
+     */
+    static constexpr uint32_t decimation = temperature_chain::decimation;
+
+    /**
+     * @brief Add a sample.
+     *
+     * The pressure in Q24.8 Pa stays below 2^31 for any pressure the sensor can measure, so it is filtered as int32_t.
+     * @param input The sample.
+     * @param output Receives the filtered sample.
+     * @return True if an output was produced.
+     */
+    bool push(const bmp280_sample_int& input, bmp280_sample_int& output) {
+        int32_t filtered_temperature;
+        int32_t filtered_pressure;
+        bool temperature_ready = temperature.push(input.temperature, filtered_temperature);
+        bool pressure_ready = pressure.push(static_cast<int32_t>(input.pressure), filtered_pressure);
+        if (!temperature_ready || !pressure_ready) {
+            return false;
+        }
+        output.temperature = filtered_temperature;
+        output.pressure = static_cast<uint32_t>(filtered_pressure);
+        return true;
+    }
+
+    /**
+     * @brief Reset both chains.
+     */
+    void reset() {
+        temperature.reset();
+        pressure.reset();
+    }
+};
+
+#endif // BMP280_FILTER_HPP
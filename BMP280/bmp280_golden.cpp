@@ -0,0 +1,156 @@
+#include "bmp280_golden.hpp"
+#include "bmp280_compensation.hpp"
+
+const bmp280_calibration_data BMP280_GOLDEN_CALIBRATIONS[BMP280_GOLDEN_CALIBRATION_COUNT] = {
+    // The example of Chapter 3.12 of the datasheet
+    {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000, 0},
+    // A sensor with a positive dig_T3
+    {27821, 26474, 50, 37705, -10568, 3024, 7331, -91, -7, 15500, -14600, 6000, 0},
+    // A sensor with a low dig_T1
+    {26375, 25993, -1000, 38045, -10496, 3024, 4318, -16, -7, 9900, -10230, 4285, 0},
+    // A sensor with a high dig_T1
+    {28943, 26860, -1000, 35162, -10855, 3024, 2468, 264, -7, 15500, -14600, 6000, 0}
+};
+
+// calibration, raw_temp, raw_press, t_fine, temperature, pressure, temperature_double, pressure_double
+const bmp280_golden_vector BMP280_GOLDEN_VECTORS[BMP280_GOLDEN_VECTOR_COUNT] = {
+    // The example of Chapter 3.12 of the datasheet
+    {0, 519888, 415148, 128422, 2508, 25767233, 25.082477930816822, 100653.25814481472},
+
+    {0, 313709, 813184, -204808, -4000, 7679951, -39.999728135328496, 29999.892485476728},
+    {0, 313709, 550666, -204808, -4000, 17919939, -39.999728135328496, 69999.978071778722},
+    {0, 313709, 347650, -204808, -4000, 25939109, -39.999728135328496, 101324.96791815625},
+    {0, 313709, 291816, -204808, -4000, 28159879, -39.999728135328496, 109999.88355585116},
+    {0, 440064, 823540, 0, 0, 7679995, 0, 29999.984701966925},
+    {0, 440064, 577916, 0, 0, 17919975, 0, 69999.907066476429},
+    {0, 440064, 387964, 0, 0, 25939175, 0, 101324.90464522666},
+    {0, 440064, 335722, 0, 0, 28159992, 0, 109999.97145020166},
+    {0, 519625, 829532, 127998, 2500, 7679990, 25.000075360130268, 29999.977174535317},
+    {0, 519625, 593623, 127998, 2500, 17919951, 25.000075360130268, 69999.851043825387},
+    {0, 519625, 411183, 127998, 2500, 25939181, 25.000075360130268, 101324.9902431579},
+    {0, 519625, 361008, 127998, 2500, 28159963, 25.000075360130268, 109999.92436449853},
+    {0, 712472, 842404, 435200, 8500, 7679952, 85.000240930326981, 29999.82088583276},
+    {0, 712472, 627162, 435200, 8500, 17919971, 85.000240930326981, 69999.908473904841},
+    {0, 712472, 460706, 435200, 8500, 25939189, 85.000240930326981, 101324.99098560827},
+    {0, 712472, 414927, 435200, 8500, 28159965, 85.000240930326981, 109999.8998952664},
+    {1, 318363, 730584, -204805, -4000, 7679967, -39.999747970558722, 29999.945625125205},
+    {1, 318363, 459505, -204805, -4000, 17919953, -39.999747970558722, 69999.981203506366},
+    {1, 318363, 249868, -204805, -4000, 25939136, -39.999747970558722, 101324.99531747449},
+    {1, 318363, 192213, -204805, -4000, 28159915, -39.999747970558722, 109999.92901976357},
+    {1, 445136, 744121, 0, 0, 7679986, 0, 29999.948859851324},
+    {1, 445136, 490334, 0, 0, 17919980, 0, 69999.924787197466},
+    {1, 445136, 294069, 0, 0, 25939197, 0, 101324.99498133062},
+    {1, 445136, 240092, 0, 0, 28159968, 0, 109999.8811914899},
+    {1, 524341, 752080, 127992, 2500, 7679960, 25.000242120622374, 29999.936960044797},
+    {1, 524341, 508229, 127992, 2500, 17919907, 25.000242120622374, 69999.841129386637},
+    {1, 524341, 319648, 127992, 2500, 25939086, 25.000242120622374, 101324.84768197672},
+    {1, 524341, 267783, 127992, 2500, 28159899, 25.000242120622374, 109999.92746660726},
+    {1, 714339, 769606, 435195, 8500, 7679978, 85.00022736853137, 29999.973134260905},
+    {1, 714339, 546864, 435195, 8500, 17919927, 85.00022736853137, 69999.842667361925},
+    {1, 714339, 374607, 435195, 8500, 25939132, 85.00022736853137, 101324.92117954347},
+    {1, 714339, 327232, 435195, 8500, 28159933, 85.00022736853137, 109999.93892415366},
+    {2, 293516, 777643, -204807, -4000, 7679952, -39.999818795519239, 29999.888449998034},
+    {2, 293516, 505219, -204807, -4000, 17919949, -39.999818795519239, 69999.983283946814},
+    {2, 293516, 293778, -204807, -4000, 25939110, -39.999818795519239, 101324.91387693712},
+    {2, 293516, 235512, -204807, -4000, 28159890, -39.999818795519239, 109999.85974559479},
+    {2, 422000, 790343, 0, 0, 7679977, 0, 29999.913215230408},
+    {2, 422000, 535203, 0, 0, 17919968, 0, 69999.878465100293},
+    {2, 422000, 337176, 0, 0, 25939161, 0, 101324.85282217244},
+    {2, 422000, 282606, 0, 0, 28159969, 0, 109999.88176250082},
+    {2, 502922, 797770, 127996, 2500, 7679959, 25.000101728875233, 29999.878306296763},
+    {2, 502922, 552555, 127996, 2500, 17919948, 25.000101728875233, 69999.886378905256},
+    {2, 502922, 362231, 127996, 2500, 25939152, 25.000101728875233, 101324.94285393487},
+    {2, 502922, 309784, 127996, 2500, 28159951, 25.000101728875233, 109999.94563903011},
+    {2, 699135, 813991, 435188, 8500, 7679939, 85.000088640375452, 29999.868831074233},
+    {2, 699135, 589845, 435188, 8500, 17919908, 85.000088640375452, 69999.88276716863},
+    {2, 699135, 415874, 435188, 8500, 25939084, 85.000088640375452, 101324.89630111551},
+    {2, 699135, 367933, 435188, 8500, 28159890, 85.000088640375452, 109999.9498077055},
+    {3, 338714, 828574, -204804, -4000, 7679971, -39.999937115733701, 29999.923463463037},
+    {3, 338714, 575146, -204804, -4000, 17919946, -39.999937115733701, 69999.89508231527},
+    {3, 338714, 379159, -204804, -4000, 25939134, -39.999937115733701, 101324.90256631658},
+    {3, 338714, 325258, -204804, -4000, 28159916, -39.999937115733701, 109999.84476631564},
+    {3, 463088, 837102, 0, 0, 7679999, 0, 29999.997434465127},
+    {3, 463088, 600189, 0, 0, 17919968, 0, 69999.878811120725},
+    {3, 463088, 416973, 0, 0, 25939186, 0, 101324.94789859715},
+    {3, 463088, 366584, 0, 0, 28159990, 0, 109999.96298683784},
+    {3, 541383, 841974, 127988, 2500, 7679964, 25.000066451709699, 29999.940835488986},
+    {3, 541383, 614569, 127988, 2500, 17919918, 25.000066451709699, 69999.910958996858},
+    {3, 541383, 438707, 127988, 2500, 25939076, 25.000066451709699, 101324.8686337726},
+    {3, 541383, 390340, 127988, 2500, 28159887, 25.000066451709699, 109999.94869089774},
+    {3, 731101, 852227, 435192, 8500, 7679950, 85.000107652361748, 29999.854344583076},
+    {3, 731101, 645090, 435192, 8500, 17919953, 85.000107652361748, 69999.957519880816},
+    {3, 731101, 484903, 435192, 8500, 25939104, 85.000107652361748, 101324.84573585645},
+    {3, 731101, 440847, 435192, 8500, 28159918, 85.000107652361748, 109999.91947989991}
+};
+
+const bme280_humidity_calibration BME280_GOLDEN_HUMIDITY_CALIBRATION = {75, 362, 0, 313, 50, 30};
+
+// raw_temp, raw_hum, t_fine, humidity
+const bme280_golden_humidity_vector BME280_GOLDEN_HUMIDITY_VECTORS[BME280_GOLDEN_HUMIDITY_VECTOR_COUNT] = {
+    {313709, 21248, -204808, 10249},
+    {313709, 26458, -204808, 35841},
+    {313709, 31708, -204808, 61442},
+    {313709, 36998, -204808, 87048},
+    {440064, 21675, 0, 10243},
+    {440064, 26393, 0, 35846},
+    {440064, 31145, 0, 61446},
+    {440064, 35933, 0, 87050},
+    {519625, 21962, 127998, 10249},
+    {519625, 26414, 127998, 35840},
+    {519625, 30902, 127998, 61450},
+    {519625, 35420, 127998, 87042},
+    {712472, 22689, 435200, 10249},
+    {712472, 26615, 435200, 35846},
+    {712472, 30571, 435200, 61452},
+    {712472, 34555, 435200, 87049},
+    {519888, 0, 128422, 0},
+    {519888, 65535, 128422, 102400}
+};
+
+static bool differs(double value, double expected, double tolerance) {
+    double difference = value - expected;
+    return difference > tolerance || difference < -tolerance;
+}
+
+bmp280_golden_result checkGoldenVectors() {
+    bmp280_golden_result result = {0, 0, 0, 0, 0, 0, 0};
+    bmp280_compensation_plan plans[BMP280_GOLDEN_CALIBRATION_COUNT];
+    for (int i = 0; i < BMP280_GOLDEN_CALIBRATION_COUNT; i++) {
+        buildCompensationPlan(BMP280_GOLDEN_CALIBRATIONS[i], plans[i]);
+    }
+
+    for (const bmp280_golden_vector& vector : BMP280_GOLDEN_VECTORS) {
+        const bmp280_calibration_data& calibration = BMP280_GOLDEN_CALIBRATIONS[vector.calibration];
+
+        int32_t t_fine;
+        int32_t temperature = compensateTemperatureInt(calibration, vector.raw_temp, t_fine);
+        result.temperature_int += (temperature != vector.temperature || t_fine != vector.t_fine) ? 1 : 0;
+        // Every path gets its own t_fine, so a wrong temperature doesn't make the pressure fail as well
+        result.pressure_int += compensatePressureInt(calibration, vector.raw_press, vector.t_fine) != vector.pressure ? 1 : 0;
+
+        int32_t double_t_fine;
+        double temperature_double = compensateTemperature(calibration, vector.raw_temp, double_t_fine);
+        result.temperature_double += differs(temperature_double, vector.temperature_double,
+                                             BMP280_GOLDEN_TEMPERATURE_TOLERANCE) ? 1 : 0;
+        double pressure_double = compensatePressure(calibration, vector.raw_press, double_t_fine);
+        result.pressure_double += differs(pressure_double, vector.pressure_double, BMP280_GOLDEN_PRESSURE_TOLERANCE) ? 1 : 0;
+
+        int32_t plan_t_fine;
+        float temperature_plan = compensateTemperature(plans[vector.calibration], vector.raw_temp, plan_t_fine);
+        result.temperature_plan += differs(temperature_plan, vector.temperature_double,
+                                           BMP280_GOLDEN_PLAN_TEMPERATURE_TOLERANCE) ? 1 : 0;
+        float pressure_plan = compensatePressure(plans[vector.calibration], vector.raw_press, plan_t_fine);
+        result.pressure_plan += differs(pressure_plan, vector.pressure_double, BMP280_GOLDEN_PLAN_PRESSURE_TOLERANCE) ? 1 : 0;
+    }
+
+    for (const bme280_golden_humidity_vector& vector : BME280_GOLDEN_HUMIDITY_VECTORS) {
+        uint32_t humidity = compensateHumidityInt(BME280_GOLDEN_HUMIDITY_CALIBRATION, vector.raw_hum, vector.t_fine);
+        result.humidity_int += humidity != vector.humidity ? 1 : 0;
+    }
+    return result;
+}
+
+uint32_t goldenMismatches(const bmp280_golden_result& result) {
+    return result.temperature_int + result.pressure_int + result.temperature_double + result.pressure_double
+         + result.temperature_plan + result.pressure_plan + result.humidity_int;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file bmp280_golden.hpp
+ * @brief Raw readings with the outputs the compensation formulas must produce for them.
+ *
+ * The expected values were computed with the reference code of Chapter 3.11.3 and Chapter 8.1 of the datasheet,
+ * outside of this library, for four calibration sets at -40, 0, 25 and 85 degrees Celsius and 300, 700, 1013.25
+ * and 1100 hPa. The BME280 humidity vectors use the formula of Chapter 4.2.3 of the BME280 datasheet at the same
+ * temperatures, with 10, 35, 60 and 85 %RH and the two raw values that are clipped to 0 and 100 %RH. The integer
+ * outputs must match exactly, so run checkGoldenVectors() after every change to the compensation code, for
+ * example with the BMP280_suite project.
+ */
+
+#ifndef BMP280_GOLDEN_HPP
+#define BMP280_GOLDEN_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Number of calibration sets in BMP280_GOLDEN_CALIBRATIONS.
+ */
+constexpr int BMP280_GOLDEN_CALIBRATION_COUNT = 4;
+
+/**
+ * @brief Number of vectors in BMP280_GOLDEN_VECTORS.
+ */
+constexpr int BMP280_GOLDEN_VECTOR_COUNT = 65;
+
+/**
+ * @brief Largest difference allowed between a double result and its expected value, in degrees Celsius.
+ */
+constexpr double BMP280_GOLDEN_TEMPERATURE_TOLERANCE = 0.000001;
+
+/**
+ * @brief Largest difference allowed between a double result and its expected value, in Pa.
+ */
+constexpr double BMP280_GOLDEN_PRESSURE_TOLERANCE = 0.00001;
+
+/**
+ * @brief Largest difference allowed between a compensation plan result and the expected double, in degrees Celsius.
+ */
+constexpr double BMP280_GOLDEN_PLAN_TEMPERATURE_TOLERANCE = 0.001;
+
+/**
+ * @brief Largest difference allowed between a compensation plan result and the expected double, in Pa.
+ */
+constexpr double BMP280_GOLDEN_PLAN_PRESSURE_TOLERANCE = 0.1;
+
+/**
+ * @struct bmp280_golden_vector
+ * @brief Struct that holds a raw reading and the expected output of every compensation formula.
+ */
+typedef struct {
+    uint8_t calibration;        /**< Index in BMP280_GOLDEN_CALIBRATIONS */
+    uint32_t raw_temp;          /**< Raw 20-bit temperature reading */
+    uint32_t raw_press;         /**< Raw 20-bit pressure reading */
+    int32_t t_fine;             /**< t_fine of compensateTemperatureInt() */
+    int32_t temperature;        /**< compensateTemperatureInt(), in 0.01 degrees Celsius */
+    uint32_t pressure;          /**< compensatePressureInt(), in Pa as Q24.8 fixed point */
+    double temperature_double;  /**< compensateTemperature(), in degrees Celsius */
+    double pressure_double;     /**< compensatePressure(), in Pa */
+} bmp280_golden_vector;
+
+/**
+ * @brief The calibration sets, the first one is the example of Chapter 3.12 of the datasheet.
+ */
+extern const bmp280_calibration_data BMP280_GOLDEN_CALIBRATIONS[BMP280_GOLDEN_CALIBRATION_COUNT];
+
+/**
+ * @brief The vectors, the example of Chapter 3.12 of the datasheet followed by 16 per calibration set.
+ *
+ * The table of Chapter 3.12 doesn't follow the reference code exactly: the integer pressure of the example is
+ * 25767233 rather than 25767236, and the double pressure 100653.258 Pa rather than 100653.27 Pa.
+ */
+extern const bmp280_golden_vector BMP280_GOLDEN_VECTORS[BMP280_GOLDEN_VECTOR_COUNT];
+
+/**
+ * @brief Number of vectors in BME280_GOLDEN_HUMIDITY_VECTORS.
+ */
+constexpr int BME280_GOLDEN_HUMIDITY_VECTOR_COUNT = 18;
+
+/**
+ * @struct bme280_golden_humidity_vector
+ * @brief Struct that holds a raw BME280 humidity reading and its expected output.
+ */
+typedef struct {
+    uint32_t raw_temp;   /**< Raw 20-bit temperature reading, with the first calibration set */
+    uint32_t raw_hum;    /**< Raw 16-bit humidity reading */
+    int32_t t_fine;      /**< t_fine of compensateTemperatureInt() */
+    uint32_t humidity;   /**< compensateHumidityInt(), in % as Q22.10 fixed point */
+} bme280_golden_humidity_vector;
+
+/**
+ * @brief The humidity calibration set, a typical BME280.
+ */
+extern const bme280_humidity_calibration BME280_GOLDEN_HUMIDITY_CALIBRATION;
+
+/**
+ * @brief The humidity vectors, with the temperature calibration of BMP280_GOLDEN_CALIBRATIONS[0].
+ */
+extern const bme280_golden_humidity_vector BME280_GOLDEN_HUMIDITY_VECTORS[BME280_GOLDEN_HUMIDITY_VECTOR_COUNT];
+
+/**
+ * @struct bmp280_golden_result
+ * @brief Struct that holds the number of vectors each compensation path got wrong.
+ */
+typedef struct {
+    uint16_t temperature_int;     /**< compensateTemperatureInt(), including t_fine */
+    uint16_t pressure_int;        /**< compensatePressureInt() */
+    uint16_t temperature_double;  /**< compensateTemperature() */
+    uint16_t pressure_double;     /**< compensatePressure() */
+    uint16_t temperature_plan;    /**< compensateTemperature() with a compensation plan */
+    uint16_t pressure_plan;       /**< compensatePressure() with a compensation plan */
+    uint16_t humidity_int;        /**< compensateHumidityInt() */
+} bmp280_golden_result;
+
+/**
+ * @brief Check every compensation function against the golden vectors.
+ * @return The number of mismatches per function, all 0 if the compensation is correct.
+ */
+bmp280_golden_result checkGoldenVectors();
+
+/**
+ * @brief Get the total number of mismatches of a check.
+ * @param result The result of checkGoldenVectors().
+ * @return The sum of the mismatches of all functions.
+ */
+uint32_t goldenMismatches(const bmp280_golden_result& result);
+
+#endif // BMP280_GOLDEN_HPP
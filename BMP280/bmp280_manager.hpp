@@ -0,0 +1,144 @@
+/**
+ * @file bmp280_manager.hpp
+ * @brief Pipelined sampling of several BMP280 sensors.
+ */
+
+#ifndef BMP280_MANAGER_HPP
+#define BMP280_MANAGER_HPP
+
+#include "bmp280.hpp"
+
+/**
+ * @brief Time a sensor may take beyond its maximum measurement time before collect() gives up on it, in us.
+ *
+ * The maximum measurement time of Chapter 3.8.1 of the datasheet already covers the conversion, so this only
+ * has to cover a few status reads on a slow bus.
+ */
+constexpr uint32_t BMP280_POLL_MARGIN_US = 5000;
+
+/**
+ * @struct bmp280_timed_sample
+ * @brief Struct that holds a sample of one sensor of a bmp280_manager.
+ */
+typedef struct {
+    uint8_t sensor;              /**< Index of the sensor, in the order the sensors were added */
+    uint_fast64_t timestamp_us;  /**< Time at which the sample was read, from hwlib::now_us() */
+    bmp280_sample_int sample;    /**< Temperature in 0.01 degrees Celsius and pressure in Pa as Q24.8 fixed point */
+} bmp280_timed_sample;
+
+/**
+ * @class bmp280_manager
+ * @brief Samples several sensors, on one or more buses, in about the time of a single conversion.
+ *
+ * Reading sensors one after another means waiting for each conversion in turn. The manager first starts
+ * a forced mode conversion on every sensor, then waits once for the longest conversion time and then reads
+ * all results, so the conversions run in parallel.
+ *
+ * Example:
+ * @code
+ * bmp280 indoor(i2c_bus, 0x76);
+ * bmp280 outdoor(i2c_bus, 0x77);
+ * bmp280_manager<2> sensors;
+ * sensors.add(indoor);
+ * sensors.add(outdoor);
+ *
+ * bmp280_timed_sample samples[2];
+ * size_t count = sensors.sampleAll(samples);
+ * @endcode
+ *
+ * @tparam max_sensors The maximum number of sensors.
+ **/
+template<size_t max_sensors>
+class bmp280_manager {
+
+private:
+    bmp280* sensors[max_sensors]; /**< The registered sensors */
+    size_t sensor_count = 0;      /**< Number of registered sensors */
+
+public:
+    /**
+     * @brief Register a sensor.
+     * @param sensor The sensor, it must outlive the manager.
+     * @return False if max_sensors sensors are registered already.
+     */
+    bool add(bmp280& sensor) {
+        if (sensor_count == max_sensors) {
+            return false;
+        }
+        sensors[sensor_count++] = &sensor;
+        return true;
+    }
+
+    /**
+     * @brief Get the number of registered sensors.
+     * @return The number of registered sensors.
+     */
+    size_t size() const {
+        return sensor_count;
+    }
+
+    /**
+     * @brief Start a conversion on every sensor without waiting for them.
+     */
+    void trigger() {
+        for (size_t i = 0; i < sensor_count; i++) {
+            sensors[i]->startMeasurement();
+        }
+    }
+
+    /**
+     * @brief Get the time until the slowest of the triggered conversions is expected to be done.
+     * @return The remaining time in microseconds, 0 if all conversions should be done already.
+     */
+    uint32_t remainingTime() {
+        uint32_t remaining = 0;
+        for (size_t i = 0; i < sensor_count; i++) {
+            uint32_t sensor_remaining = sensors[i]->remainingMeasurementTime();
+            if (sensor_remaining > remaining) {
+                remaining = sensor_remaining;
+            }
+        }
+        return remaining;
+    }
+
+    /**
+     * @brief Read the results of the triggered conversions.
+     *
+     * Call this after remainingTime() has passed. Sensors that are still converting are polled until they are done.
+     * A sensor that isn't done BMP280_POLL_MARGIN_US after its maximum measurement time, for example because it
+     * doesn't answer, is left out, so check the sensor field of the samples.
+     * @param samples Receives one sample per sensor that was done, in the order the sensors were added.
+     * @return The number of samples, less than size() if a sensor failed.
+     */
+    size_t collect(bmp280_timed_sample* samples) {
+        size_t count = 0;
+        for (size_t i = 0; i < sensor_count; i++) {
+            uint_fast64_t deadline_us = hwlib::now_us() + sensors[i]->remainingMeasurementTime() + BMP280_POLL_MARGIN_US;
+            bool done = sensors[i]->poll();
+            while (!done && hwlib::now_us() < deadline_us) {
+                done = sensors[i]->poll();
+            }
+            if (!done) {
+                continue;
+            }
+            samples[count].sensor = static_cast<uint8_t>(i);
+            samples[count].sample = sensors[i]->collectInt();
+            samples[count].timestamp_us = hwlib::now_us();
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Trigger all sensors, wait for the slowest conversion and read all results.
+     * @param samples Receives one sample per sensor that was done, in the order the sensors were added.
+     * @return The number of samples, less than size() if a sensor failed.
+     */
+    size_t sampleAll(bmp280_timed_sample* samples) {
+        trigger();
+        hwlib::wait_us(remainingTime());
+        return collect(samples);
+    }
+};
+
+#endif // BMP280_MANAGER_HPP
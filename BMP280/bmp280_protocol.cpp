@@ -0,0 +1,203 @@
+#include "bmp280_protocol.hpp"
+#include "bmp280_calibration.hpp"
+
+// Checks the type and length before the payload is received, so a corrupted header can't swallow the next frames
+static bool isValidHeader(uint8_t type, uint8_t payload_length) {
+    if (type == BMP280_FRAME_CALIBRATION) {
+        return payload_length == BMP280_CALIBRATION_PAYLOAD_LENGTH;
+    }
+    if (type == BMP280_FRAME_SAMPLES) {
+        return payload_length > 2 && (payload_length - 2) % BMP280_RECORD_LENGTH == 0;
+    }
+    return false;
+}
+
+bmp280_frame_encoder::bmp280_frame_encoder(uint8_t records_per_frame) :
+    frame_size(0), records_per_frame(records_per_frame), record_count(0), sequence(0)
+{
+    if (this->records_per_frame < 1) {
+        this->records_per_frame = 1;
+    } else if (this->records_per_frame > BMP280_FRAME_MAX_RECORDS) {
+        this->records_per_frame = BMP280_FRAME_MAX_RECORDS;
+    }
+}
+
+void bmp280_frame_encoder::finishFrame(frame_type type, uint8_t payload_length) {
+    frame[0] = BMP280_FRAME_SYNC0;
+    frame[1] = BMP280_FRAME_SYNC1;
+    frame[2] = static_cast<uint8_t>(type);
+    frame[3] = payload_length;
+
+    // The sync bytes aren't part of the CRC
+    uint16_t crc = bmp280Crc16(frame + 2, payload_length + 2);
+    frame[4 + payload_length] = static_cast<uint8_t>(crc & 0xFF);
+    frame[5 + payload_length] = static_cast<uint8_t>(crc >> 8);
+    frame_size = payload_length + BMP280_FRAME_OVERHEAD;
+}
+
+int bmp280_frame_encoder::encodeCalibration(const bmp280_calibration_data& calibration, uint32_t period_us) {
+    bmp280_calibration_blob blob;
+    serializeCalibration(calibration, blob);
+
+    uint8_t* payload = frame + 4;
+    payload[0] = BMP280_PROTOCOL_VERSION;
+    for (int i = 0; i < 4; i++) {
+        payload[1 + i] = static_cast<uint8_t>(period_us >> (8 * i));
+    }
+    for (int i = 0; i < BMP280_CALIBRATION_LENGTH; i++) {
+        payload[5 + i] = blob.data[i];
+    }
+
+    // The samples that were added are lost, the next sample frame starts at the current sequence number
+    record_count = 0;
+    finishFrame(BMP280_FRAME_CALIBRATION, BMP280_CALIBRATION_PAYLOAD_LENGTH);
+    return frame_size;
+}
+
+int bmp280_frame_encoder::add(const bmp280_raw_sample& raw) {
+    if (record_count == 0) {
+        frame_size = 0;
+        frame[4] = static_cast<uint8_t>(sequence & 0xFF);
+        frame[5] = static_cast<uint8_t>(sequence >> 8);
+    }
+
+    packRawSample(raw, frame + 6 + record_count * BMP280_RECORD_LENGTH);
+    record_count++;
+    sequence++;
+    if (record_count < records_per_frame) {
+        return 0;
+    }
+    return flush();
+}
+
+int bmp280_frame_encoder::flush() {
+    if (record_count == 0) {
+        return 0;
+    }
+    finishFrame(BMP280_FRAME_SAMPLES, static_cast<uint8_t>(2 + record_count * BMP280_RECORD_LENGTH));
+    record_count = 0;
+    return frame_size;
+}
+
+const uint8_t* bmp280_frame_encoder::getFrame() const {
+    return frame;
+}
+
+uint16_t bmp280_frame_encoder::getSequence() const {
+    return sequence;
+}
+
+bmp280_frame_decoder::bmp280_frame_decoder() :
+    received(0), frames(0), crc_errors(0), skipped_bytes(0)
+{}
+
+bool bmp280_frame_decoder::feed(uint8_t byte) {
+    // Wait for the sync bytes, the second one may be followed by the first one of a real frame
+    if (received == 0) {
+        if (byte == BMP280_FRAME_SYNC0) {
+            frame[received++] = byte;
+        } else {
+            skipped_bytes++;
+        }
+        return false;
+    }
+    if (received == 1) {
+        if (byte == BMP280_FRAME_SYNC1) {
+            frame[received++] = byte;
+        } else {
+            skipped_bytes++;
+            received = (byte == BMP280_FRAME_SYNC0) ? 1 : 0;
+        }
+        return false;
+    }
+
+    frame[received++] = byte;
+    if (received == 4 && !isValidHeader(frame[2], frame[3])) {
+        skipped_bytes += 4;
+        received = 0;
+        return false;
+    }
+    if (received < 4 || received < frame[3] + BMP280_FRAME_OVERHEAD) {
+        return false;
+    }
+
+    // The whole frame is in, a corrupted frame is dropped and the search for the next one starts after it
+    received = 0;
+    uint8_t payload_length = frame[3];
+    uint16_t crc = static_cast<uint16_t>(frame[4 + payload_length] | (frame[5 + payload_length] << 8));
+    if (bmp280Crc16(frame + 2, payload_length + 2) != crc) {
+        crc_errors++;
+        return false;
+    }
+    frames++;
+    return true;
+}
+
+uint8_t bmp280_frame_decoder::getType() const {
+    return frame[2];
+}
+
+const uint8_t* bmp280_frame_decoder::getPayload() const {
+    return frame + 4;
+}
+
+uint8_t bmp280_frame_decoder::getPayloadLength() const {
+    return frame[3];
+}
+
+uint32_t bmp280_frame_decoder::frameCount() const {
+    return frames;
+}
+
+uint32_t bmp280_frame_decoder::crcErrorCount() const {
+    return crc_errors;
+}
+
+uint32_t bmp280_frame_decoder::skippedCount() const {
+    return skipped_bytes;
+}
+
+// Two 20-bit values in 5 bytes, the temperature in the low bits
+void packRawSample(const bmp280_raw_sample& raw, uint8_t* record) {
+    uint32_t temperature = raw.temperature & 0xFFFFF;
+    uint32_t pressure = raw.pressure & 0xFFFFF;
+    record[0] = static_cast<uint8_t>(temperature);
+    record[1] = static_cast<uint8_t>(temperature >> 8);
+    record[2] = static_cast<uint8_t>((temperature >> 16) | (pressure << 4));
+    record[3] = static_cast<uint8_t>(pressure >> 4);
+    record[4] = static_cast<uint8_t>(pressure >> 12);
+}
+
+bmp280_raw_sample unpackRawSample(const uint8_t* record) {
+    bmp280_raw_sample raw;
+    raw.temperature = record[0] | (static_cast<uint32_t>(record[1]) << 8) | (static_cast<uint32_t>(record[2] & 0x0F) << 16);
+    raw.pressure = (record[2] >> 4) | (static_cast<uint32_t>(record[3]) << 4) | (static_cast<uint32_t>(record[4]) << 12);
+    return raw;
+}
+
+bool decodeCalibrationFrame(const uint8_t* payload, uint8_t payload_length, bmp280_calibration_data& calibration, uint32_t& period_us) {
+    if (payload_length != BMP280_CALIBRATION_PAYLOAD_LENGTH || payload[0] != BMP280_PROTOCOL_VERSION) {
+        return false;
+    }
+    period_us = 0;
+    for (int i = 0; i < 4; i++) {
+        period_us |= static_cast<uint32_t>(payload[1 + i]) << (8 * i);
+    }
+    decodeCalibration(payload + 5, calibration);
+    calibration.t_fine = 0;
+    return true;
+}
+
+int decodeSampleFrame(const uint8_t* payload, uint8_t payload_length, uint16_t& sequence, bmp280_raw_sample* samples) {
+    if (payload_length < 2 || (payload_length - 2) % BMP280_RECORD_LENGTH != 0) {
+        return -1;
+    }
+    sequence = static_cast<uint16_t>(payload[0] | (payload[1] << 8));
+
+    int count = (payload_length - 2) / BMP280_RECORD_LENGTH;
+    const uint8_t* record = payload + 2;
+    for (int i = 0; i < count; i++, record += BMP280_RECORD_LENGTH) {
+        samples[i] = unpackRawSample(record);
+    }
+    return count;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file bmp280_protocol.hpp
+ * @brief Compact binary framing of raw samples for streaming over a serial link.
+ *
+ * Formatting samples as text costs about 120 bytes per sample and a lot of CPU time on the target. The binary
+ * protocol sends the calibration registers once, in a header frame, and after that only the raw 20-bit readings,
+ * 5 bytes per sample, batched into frames. The receiver compensates the samples itself.
+ *
+ * Every frame looks like this, multi-byte fields are sent low byte first:
+ *
+ *     sync (0xB2 0x80) | type | payload length | payload | CRC-16 of type, length and payload
+ *
+ * A calibration frame (BMP280_FRAME_CALIBRATION) holds the protocol version, the time between two samples in
+ * microseconds (4 bytes) and the 24 calibration registers 0x88..0x9F. A sample frame (BMP280_FRAME_SAMPLES) holds
+ * the 16-bit sequence number of its first sample, followed by the samples. Each sample is the raw temperature
+ * in bits 0..19 and the raw pressure in bits 20..39 of a 40-bit value. The receiver uses the sequence numbers to
+ * detect lost frames, and resynchronizes on the sync bytes after a corrupted frame.
+ */
+
+#ifndef BMP280_PROTOCOL_HPP
+#define BMP280_PROTOCOL_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Version of the protocol, sent in the calibration frame.
+ */
+constexpr uint8_t BMP280_PROTOCOL_VERSION = 1;
+
+/**
+ * @brief The first sync byte of a frame.
+ */
+constexpr uint8_t BMP280_FRAME_SYNC0 = 0xB2;
+
+/**
+ * @brief The second sync byte of a frame.
+ */
+constexpr uint8_t BMP280_FRAME_SYNC1 = 0x80;
+
+/**
+ * @brief Bytes of a frame besides the payload: two sync bytes, type, length and CRC.
+ */
+constexpr uint8_t BMP280_FRAME_OVERHEAD = 6;
+
+/**
+ * @brief Maximum length of a frame payload.
+ */
+constexpr uint8_t BMP280_FRAME_MAX_PAYLOAD = 255;
+
+/**
+ * @brief Length of one packed raw sample in a sample frame.
+ */
+constexpr uint8_t BMP280_RECORD_LENGTH = 5;
+
+/**
+ * @brief Length of the payload of a calibration frame.
+ */
+constexpr uint8_t BMP280_CALIBRATION_PAYLOAD_LENGTH = 1 + 4 + BMP280_CALIBRATION_LENGTH;
+
+/**
+ * @brief Maximum number of samples in one sample frame.
+ */
+constexpr uint8_t BMP280_FRAME_MAX_RECORDS = (BMP280_FRAME_MAX_PAYLOAD - 2) / BMP280_RECORD_LENGTH;
+
+/**
+ * @brief Frame types.
+ */
+enum frame_type {
+    BMP280_FRAME_CALIBRATION = 0x01,   /**< Protocol version, sample period and calibration registers */
+    BMP280_FRAME_SAMPLES = 0x02        /**< Sequence number and packed raw samples */
+};
+
+/**
+ * @class bmp280_frame_encoder
+ * @brief Builds frames in a buffer, the caller sends the bytes over whatever link it uses.
+ **/
+class bmp280_frame_encoder {
+
+private:
+    uint8_t frame[BMP280_FRAME_MAX_PAYLOAD + BMP280_FRAME_OVERHEAD]; /**< The frame being built */
+    int frame_size;            /**< Number of bytes in a finished frame, 0 while building */
+    uint8_t records_per_frame; /**< Number of samples after which a sample frame is finished */
+    uint8_t record_count;      /**< Number of samples in the frame being built */
+    uint16_t sequence;         /**< Sequence number of the next sample */
+
+    /**
+     * @brief Write the header and CRC around a payload that is already in place.
+     * @param type The frame type.
+     * @param payload_length The length of the payload.
+     */
+    void finishFrame(frame_type type, uint8_t payload_length);
+
+public:
+    /**
+     * @brief Constructor for the bmp280_frame_encoder class.
+     *
+     * More samples per frame means less overhead per sample, but a longer delay before a sample is sent.
+     * @param records_per_frame Number of samples per frame, at most BMP280_FRAME_MAX_RECORDS.
+     */
+    bmp280_frame_encoder(uint8_t records_per_frame = 8);
+
+    /**
+     * @brief Build a calibration frame.
+     *
+     * Send one at the start of the stream and repeat it now and then, so a receiver that starts late can
+     * decode the stream. A partly built sample frame is dropped.
+     * @param calibration The calibration data of the sensor.
+     * @param period_us The time between two samples in microseconds, 0 if unknown.
+     * @return The length of the frame.
+     */
+    int encodeCalibration(const bmp280_calibration_data& calibration, uint32_t period_us);
+
+    /**
+     * @brief Add a sample to the sample frame being built.
+     * @param raw The raw sample.
+     * @return The length of the frame when it is finished, otherwise 0.
+     */
+    int add(const bmp280_raw_sample& raw);
+
+    /**
+     * @brief Finish the sample frame being built, even if it isn't full.
+     * @return The length of the frame, 0 if it holds no samples.
+     */
+    int flush();
+
+    /**
+     * @brief Get the last finished frame.
+     * @return The bytes of the frame, valid until the next call to encodeCalibration(), add() or flush().
+     */
+    const uint8_t* getFrame() const;
+
+    /**
+     * @brief Get the sequence number of the next sample.
+     * @return The sequence number, wraps around at 65536.
+     */
+    uint16_t getSequence() const;
+};
+
+/**
+ * @class bmp280_frame_decoder
+ * @brief Finds and checks frames in a byte stream, one byte at a time.
+ **/
+class bmp280_frame_decoder {
+
+private:
+    uint8_t frame[BMP280_FRAME_MAX_PAYLOAD + BMP280_FRAME_OVERHEAD]; /**< The frame being received */
+    int received;                /**< Number of bytes of the frame received */
+    uint32_t frames;             /**< Number of correct frames */
+    uint32_t crc_errors;         /**< Number of frames with a wrong CRC */
+    uint32_t skipped_bytes;      /**< Number of bytes outside frames */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_frame_decoder class.
+     */
+    bmp280_frame_decoder();
+
+    /**
+     * @brief Process one received byte.
+     * @param byte The byte.
+     * @return True if the byte completed a frame with a correct CRC.
+     */
+    bool feed(uint8_t byte);
+
+    /**
+     * @brief Get the type of the last completed frame.
+     * @return The frame type.
+     */
+    uint8_t getType() const;
+
+    /**
+     * @brief Get the payload of the last completed frame.
+     * @return The payload bytes, valid until the next call to feed().
+     */
+    const uint8_t* getPayload() const;
+
+    /**
+     * @brief Get the payload length of the last completed frame.
+     * @return The number of payload bytes.
+     */
+    uint8_t getPayloadLength() const;
+
+    /**
+     * @brief Get the number of frames with a correct CRC.
+     * @return The number of frames.
+     */
+    uint32_t frameCount() const;
+
+    /**
+     * @brief Get the number of frames that were dropped because of a wrong CRC.
+     * @return The number of frames.
+     */
+    uint32_t crcErrorCount() const;
+
+    /**
+     * @brief Get the number of bytes that were skipped while looking for the sync bytes.
+     * @return The number of bytes.
+     */
+    uint32_t skippedCount() const;
+};
+
+/**
+ * @brief Pack a raw sample into 5 bytes, the temperature in bits 0..19 and the pressure in bits 20..39.
+ * @param raw The raw sample.
+ * @param record Receives the 5 bytes, low byte first.
+ */
+void packRawSample(const bmp280_raw_sample& raw, uint8_t* record);
+
+/**
+ * @brief Unpack a raw sample packed by packRawSample().
+ * @param record The 5 bytes.
+ * @return The raw sample.
+ */
+bmp280_raw_sample unpackRawSample(const uint8_t* record);
+
+/**
+ * @brief Decode the payload of a calibration frame.
+ * @param payload The payload.
+ * @param payload_length The payload length.
+ * @param calibration Receives the calibration coefficients.
+ * @param period_us Receives the time between two samples in microseconds.
+ * @return False if the payload has the wrong length or protocol version.
+ */
+bool decodeCalibrationFrame(const uint8_t* payload, uint8_t payload_length, bmp280_calibration_data& calibration, uint32_t& period_us);
+
+/**
+ * @brief Decode the payload of a sample frame.
+ * @param payload The payload.
+ * @param payload_length The payload length.
+ * @param sequence Receives the sequence number of the first sample.
+ * @param samples Receives the samples, room for BMP280_FRAME_MAX_RECORDS is always enough.
+ * @return The number of samples, -1 if the payload length is wrong.
+ */
+int decodeSampleFrame(const uint8_t* payload, uint8_t payload_length, uint16_t& sequence, bmp280_raw_sample* samples);
+
+#endif // BMP280_PROTOCOL_HPP
@@ -0,0 +1,147 @@
+#include "bmp280_replay.hpp"
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include "bmp280_calibration.hpp"
+#include "bmp280_batch.hpp"
+
+// Samples per call to compensateBatch(), the buffers of a block fit in the L1 cache
+static const size_t block_samples = 1024;
+
+// Aim for parts of at least this many samples, so the cost of taking a part is negligible
+static const uint64_t part_samples = 65536;
+
+/**
+ * @struct replay_job
+ * @brief The shared state of the threads working on one archive.
+ */
+struct replay_job {
+    const uint8_t* archive;                /**< The archive */
+    const bmp280_archive_header& header;   /**< Its header */
+    bmp280_calibration_data calibration;   /**< Its calibration data */
+    uint64_t bucket_us;                    /**< Length of a bucket */
+    uint64_t first_bucket;                 /**< Number of the bucket of the first sample */
+    std::vector<bmp280_bucket>& buckets;   /**< The buckets */
+    size_t buckets_per_part;               /**< Number of buckets handed to a thread at once */
+    std::atomic<size_t> next_part;         /**< The next part that no thread took yet */
+};
+
+// Index of the first sample taken at or after a time
+static uint64_t firstSampleAt(const bmp280_archive_header& header, uint64_t time_us) {
+    if (time_us <= header.start_us) {
+        return 0;
+    }
+    uint64_t index = (time_us - header.start_us + header.period_us - 1) / header.period_us;
+    return index < header.sample_count ? index : header.sample_count;
+}
+
+// Computes the buckets first..last-1, no other thread touches them
+static void replayBuckets(replay_job& job, size_t first, size_t last) {
+    for (size_t b = first; b < last; b++) {
+        bmp280_bucket& bucket = job.buckets[b];
+        bucket.start_us = (job.first_bucket + b) * job.bucket_us;
+        bucket.count = 0;
+        bucket.temperature_min = bucket.pressure_min = INFINITY;
+        bucket.temperature_max = bucket.pressure_max = -INFINITY;
+        bucket.temperature_mean = bucket.pressure_mean = 0;
+    }
+
+    uint64_t index = firstSampleAt(job.header, (job.first_bucket + first) * job.bucket_us);
+    uint64_t end = firstSampleAt(job.header, (job.first_bucket + last) * job.bucket_us);
+
+    // The bucket of the next sample, and the time at which the bucket after it starts
+    size_t current = first;
+    uint64_t boundary_us = (job.first_bucket + first + 1) * job.bucket_us;
+    uint64_t time_us = job.header.start_us + index * job.header.period_us;
+
+    uint32_t raw_temp[block_samples];
+    uint32_t raw_press[block_samples];
+    double temperature[block_samples];
+    double pressure[block_samples];
+    while (index < end) {
+        size_t count = end - index < block_samples ? static_cast<size_t>(end - index) : block_samples;
+        for (size_t i = 0; i < count; i++) {
+            bmp280_raw_sample raw = readArchiveSample(job.archive, index + i);
+            raw_temp[i] = raw.temperature;
+            raw_press[i] = raw.pressure;
+        }
+        compensateBatch(job.calibration, raw_temp, raw_press, count, temperature, pressure);
+
+        for (size_t i = 0; i < count; i++, time_us += job.header.period_us) {
+            while (time_us >= boundary_us) {
+                current++;
+                boundary_us += job.bucket_us;
+            }
+            if (raw_temp[i] == BMP280_RAW_SKIPPED || raw_press[i] == BMP280_RAW_SKIPPED) {
+                continue;
+            }
+
+            bmp280_bucket& bucket = job.buckets[current];
+            bucket.count++;
+            bucket.temperature_min = temperature[i] < bucket.temperature_min ? temperature[i] : bucket.temperature_min;
+            bucket.temperature_max = temperature[i] > bucket.temperature_max ? temperature[i] : bucket.temperature_max;
+            bucket.temperature_mean += temperature[i];
+            bucket.pressure_min = pressure[i] < bucket.pressure_min ? pressure[i] : bucket.pressure_min;
+            bucket.pressure_max = pressure[i] > bucket.pressure_max ? pressure[i] : bucket.pressure_max;
+            bucket.pressure_mean += pressure[i];
+        }
+        index += count;
+    }
+
+    // The means were summed, the statistics of an empty bucket are not a number
+    for (size_t b = first; b < last; b++) {
+        bmp280_bucket& bucket = job.buckets[b];
+        if (bucket.count == 0) {
+            bucket.temperature_min = bucket.temperature_max = bucket.temperature_mean = NAN;
+            bucket.pressure_min = bucket.pressure_max = bucket.pressure_mean = NAN;
+        } else {
+            bucket.temperature_mean /= bucket.count;
+            bucket.pressure_mean /= bucket.count;
+        }
+    }
+}
+
+static void replayWorker(replay_job& job) {
+    size_t part;
+    while ((part = job.next_part++) * job.buckets_per_part < job.buckets.size()) {
+        size_t first = part * job.buckets_per_part;
+        size_t last = first + job.buckets_per_part < job.buckets.size() ? first + job.buckets_per_part : job.buckets.size();
+        replayBuckets(job, first, last);
+    }
+}
+
+bool replayArchive(const uint8_t* archive, size_t size, uint64_t bucket_us, int threads,
+                   bmp280_archive_header& header, std::vector<bmp280_bucket>& buckets) {
+    bmp280_calibration_data calibration;
+    if (!readArchiveHeader(archive, size, header) || header.period_us == 0 || bucket_us == 0
+        || !deserializeCalibration(header.calibration, calibration)) {
+        return false;
+    }
+    buckets.clear();
+    if (header.sample_count == 0) {
+        return true;
+    }
+
+    uint64_t first_bucket = header.start_us / bucket_us;
+    uint64_t last_bucket = (header.start_us + (header.sample_count - 1) * header.period_us) / bucket_us;
+    buckets.resize(last_bucket - first_bucket + 1);
+
+    // Several parts per thread so the load stays balanced, but not so many that parts get tiny
+    threads = threads < 1 ? 1 : threads;
+    uint64_t parts = header.sample_count / part_samples;
+    parts = parts < static_cast<uint64_t>(threads) * 4 ? static_cast<uint64_t>(threads) * 4 : parts;
+    parts = parts > buckets.size() ? buckets.size() : parts;
+
+    replay_job job{archive, header, calibration, bucket_us, first_bucket, buckets,
+                   static_cast<size_t>((buckets.size() + parts - 1) / parts), {0}};
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(replayWorker, std::ref(job));
+    }
+    replayWorker(job);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return true;
+}
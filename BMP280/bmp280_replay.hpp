@@ -0,0 +1,50 @@
+/**
+ * @file bmp280_replay.hpp
+ * @brief Multi-threaded recompute of archives on a PC: compensation and aggregation per time bucket.
+ *
+ * The samples of an archive are split into parts at bucket boundaries, so every bucket is computed by exactly
+ * one thread and no locking or merging is needed. A fixed set of threads takes the parts one by one, so threads
+ * that finish early take over work from slower ones. The samples are compensated in blocks with compensateBatch(),
+ * the results don't depend on the number of threads.
+ *
+ * This uses std::thread and is meant for native builds only.
+ */
+
+#ifndef BMP280_REPLAY_HPP
+#define BMP280_REPLAY_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "bmp280_defs.hpp"
+#include "bmp280_archive.hpp"
+
+/**
+ * @struct bmp280_bucket
+ * @brief Struct that holds the aggregated samples of one time bucket.
+ */
+typedef struct {
+    uint64_t start_us;        /**< Start of the bucket, a multiple of the bucket length */
+    uint32_t count;           /**< Number of samples in the bucket, lost samples not included */
+    double temperature_min;   /**< Lowest temperature in degrees Celsius */
+    double temperature_max;   /**< Highest temperature in degrees Celsius */
+    double temperature_mean;  /**< Mean temperature in degrees Celsius */
+    double pressure_min;      /**< Lowest pressure in Pa */
+    double pressure_max;      /**< Highest pressure in Pa */
+    double pressure_mean;     /**< Mean pressure in Pa */
+} bmp280_bucket;
+
+/**
+ * @brief Compensate the samples of an archive and aggregate them per time bucket.
+ * @param archive The archive, for example a memory mapped file.
+ * @param size The size of the archive in bytes.
+ * @param bucket_us The length of a bucket in microseconds.
+ * @param threads The number of threads to use, 1 to do all work in the calling thread.
+ * @param header Receives the header of the archive.
+ * @param buckets Receives every bucket from the first to the last sample, including buckets without samples.
+ * @return False if the header is invalid, or has a period of 0.
+ */
+bool replayArchive(const uint8_t* archive, size_t size, uint64_t bucket_us, int threads,
+                   bmp280_archive_header& header, std::vector<bmp280_bucket>& buckets);
+
+#endif // BMP280_REPLAY_HPP
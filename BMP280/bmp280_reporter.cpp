@@ -0,0 +1,67 @@
+#include "bmp280_reporter.hpp"
+
+bmp280_change_filter::bmp280_change_filter(const bmp280_deadband& deadband) :
+    deadband(deadband), reported(0), direction(0), reported_us(0), started(false)
+{}
+
+bool bmp280_change_filter::update(int32_t value, uint_fast64_t now_us) {
+    bool report = !started;
+
+    if (!report && deadband.max_silence_ms != 0) {
+        report = now_us - reported_us >= static_cast<uint_fast64_t>(deadband.max_silence_ms) * 1000;
+    }
+
+    int64_t change = static_cast<int64_t>(value) - reported;
+    int8_t change_direction = change > 0 ? 1 : (change < 0 ? -1 : 0);
+    if (!report && change != 0) {
+        // The larger of the absolute and relative deadband, widened when the direction reverses
+        int64_t magnitude = reported < 0 ? -static_cast<int64_t>(reported) : reported;
+        int64_t threshold = magnitude * deadband.relative_ppm / 1000000;
+        if (threshold < deadband.absolute) {
+            threshold = deadband.absolute;
+        }
+        if (change_direction == -direction) {
+            threshold += deadband.hysteresis;
+        }
+        report = (change < 0 ? -change : change) >= threshold;
+    }
+
+    if (report) {
+        if (started && change_direction != 0) {
+            direction = change_direction;
+        }
+        reported = value;
+        reported_us = now_us;
+        started = true;
+    }
+    return report;
+}
+
+int32_t bmp280_change_filter::getReported() const {
+    return reported;
+}
+
+void bmp280_change_filter::reset() {
+    direction = 0;
+    started = false;
+}
+
+bmp280_reporter::bmp280_reporter(const bmp280_deadband& temperature, const bmp280_deadband& pressure) :
+    temperature(temperature), pressure(pressure)
+{}
+
+uint8_t bmp280_reporter::update(const bmp280_sample_int& sample, uint_fast64_t now_us) {
+    uint8_t flags = REPORT_NONE;
+    if (temperature.update(sample.temperature, now_us)) {
+        flags |= REPORT_TEMPERATURE;
+    }
+    if (pressure.update(static_cast<int32_t>(sample.pressure), now_us)) {
+        flags |= REPORT_PRESSURE;
+    }
+    return flags;
+}
+
+void bmp280_reporter::reset() {
+    temperature.reset();
+    pressure.reset();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file bmp280_reporter.hpp
+ * @brief Change-driven reporting of samples with deadbands, hysteresis and a heartbeat.
+ *
+ * Most samples of a slowly changing temperature or pressure are redundant. A bmp280_reporter decides per sample
+ * whether it is worth printing, drawing or logging, so the formatting and the I/O are only done when a value
+ * moved by a meaningful amount, or when nothing was reported for too long.
+ */
+
+#ifndef BMP280_REPORTER_HPP
+#define BMP280_REPORTER_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @struct bmp280_deadband
+ * @brief Struct that holds the reporting settings of one channel.
+ *
+ * A new value is reported when it differs from the last reported value by at least the larger of the absolute
+ * and the relative deadband. When the value moves in the opposite direction of the last reported change, the
+ * hysteresis is added to that, so a value that hovers around a threshold isn't reported back and forth.
+ */
+typedef struct {
+    int32_t absolute;        /**< Absolute deadband, in the unit of the channel */
+    uint32_t relative_ppm;   /**< Relative deadband in parts per million of the last reported value */
+    int32_t hysteresis;      /**< Extra deadband after a change of direction, in the unit of the channel */
+    uint32_t max_silence_ms; /**< Report anyway when nothing was reported for this long, 0 disables the heartbeat */
+} bmp280_deadband;
+
+/**
+ * @class bmp280_change_filter
+ * @brief Decides for one channel whether a new value must be reported.
+ **/
+class bmp280_change_filter {
+
+private:
+    bmp280_deadband deadband;     /**< Reporting settings */
+    int32_t reported;             /**< Last reported value */
+    int8_t direction;             /**< Direction of the last reported change: -1, 0 or 1 */
+    uint_fast64_t reported_us;    /**< Time of the last report */
+    bool started;                 /**< False until the first value has been reported */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_change_filter class.
+     * @param deadband The reporting settings.
+     */
+    bmp280_change_filter(const bmp280_deadband& deadband);
+
+    /**
+     * @brief Check whether a value must be reported, and remember it as reported if so.
+     *
+     * The first value is always reported.
+     * @param value The new value.
+     * @param now_us The current time, for example from hwlib::now_us().
+     * @return True if the value changed enough or the heartbeat expired.
+     */
+    bool update(int32_t value, uint_fast64_t now_us);
+
+    /**
+     * @brief Get the last reported value.
+     * @return The last value for which update() returned true.
+     */
+    int32_t getReported() const;
+
+    /**
+     * @brief Forget the last reported value, the next value is always reported.
+     */
+    void reset();
+};
+
+/**
+ * @brief Flags returned by bmp280_reporter::update().
+ */
+enum report_flags {
+    REPORT_NONE = 0x00,          /**< Nothing to report */
+    REPORT_TEMPERATURE = 0x01,   /**< The temperature changed */
+    REPORT_PRESSURE = 0x02       /**< The pressure changed */
+};
+
+/**
+ * @class bmp280_reporter
+ * @brief Change filters for the temperature and pressure of integer samples.
+ *
+ * The temperature deadband is in 0.01 degrees Celsius and the pressure deadband in Pa / 256, the units of
+ * bmp280_sample_int.
+ *
+ * @code
+ * bmp280_reporter reporter(
+ *     bmp280_deadband{10, 0, 5, 60000},    // 0.1 C, 0.05 C extra after a reversal, at least once a minute
+ *     bmp280_deadband{0, 50, 0, 60000});   // 50 ppm, about 5 Pa at sea level
+ *
+ * uint8_t changed = reporter.update(sensor.collectInt(), hwlib::now_us());
+ * if (changed & REPORT_TEMPERATURE) { ... }
+ * @endcode
+ **/
+class bmp280_reporter {
+
+private:
+    bmp280_change_filter temperature;  /**< Change filter of the temperature */
+    bmp280_change_filter pressure;     /**< Change filter of the pressure */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_reporter class.
+     * @param temperature The reporting settings of the temperature, in 0.01 degrees Celsius.
+     * @param pressure The reporting settings of the pressure, in Pa / 256.
+     */
+    bmp280_reporter(const bmp280_deadband& temperature, const bmp280_deadband& pressure);
+
+    /**
+     * @brief Check which channels of a sample must be reported.
+     * @param sample The new sample.
+     * @param now_us The current time, for example from hwlib::now_us().
+     * @return A combination of report_flags.
+     */
+    uint8_t update(const bmp280_sample_int& sample, uint_fast64_t now_us);
+
+    /**
+     * @brief Forget the reported values, the next sample reports both channels.
+     */
+    void reset();
+};
+
+#endif // BMP280_REPORTER_HPP
@@ -0,0 +1,118 @@
+/**
+ * @file bmp280_ring_buffer.hpp
+ * @brief Fixed-capacity ring buffer for samples.
+ */
+
+#ifndef BMP280_RING_BUFFER_HPP
+#define BMP280_RING_BUFFER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @class bmp280_ring_buffer
+ * @brief Fixed-capacity FIFO that never allocates.
+ *
+ * When the buffer is full the oldest element is overwritten, so consumers always get the most recent data.
+ * The number of overwritten elements is counted, so lost samples can be detected.
+ *
+ * @tparam T The element type.
+ * @tparam capacity The maximum number of elements.
+ **/
+template<typename T, size_t capacity>
+class bmp280_ring_buffer {
+
+    static_assert(capacity > 0, "a ring buffer needs room for at least one element");
+
+private:
+    T elements[capacity]; /**< Storage for the elements */
+    size_t head = 0;      /**< Index of the oldest element */
+    size_t count = 0;     /**< Number of stored elements */
+    uint32_t lost = 0;    /**< Number of elements that were overwritten before they were read */
+
+public:
+    /**
+     * @brief Add an element, overwriting the oldest one if the buffer is full.
+     * @param element The element to add.
+     */
+    void push(const T& element) {
+        elements[(head + count) % capacity] = element;
+        if (count < capacity) {
+            count++;
+        } else {
+            head = (head + 1) % capacity;
+            lost++;
+        }
+    }
+
+    /**
+     * @brief Remove the oldest element.
+     * @param element Receives the removed element.
+     * @return False if the buffer was empty.
+     */
+    bool pop(T& element) {
+        if (count == 0) {
+            return false;
+        }
+        element = elements[head];
+        head = (head + 1) % capacity;
+        count--;
+        return true;
+    }
+
+    /**
+     * @brief Remove up to max_count of the oldest elements at once.
+     * @param destination Receives the removed elements, oldest first.
+     * @param max_count The maximum number of elements to remove.
+     * @return The number of removed elements.
+     */
+    size_t pop(T* destination, size_t max_count) {
+        size_t n = 0;
+        while (n < max_count && pop(destination[n])) {
+            n++;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Get the number of stored elements.
+     * @return The number of stored elements.
+     */
+    size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Check whether the buffer is empty.
+     * @return True if there are no stored elements.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @brief Check whether the buffer is full.
+     * @return True if the next push() overwrites the oldest element.
+     */
+    bool full() const {
+        return count == capacity;
+    }
+
+    /**
+     * @brief Get the number of elements that were overwritten before they were read.
+     * @return The number of lost elements.
+     */
+    uint32_t lostCount() const {
+        return lost;
+    }
+
+    /**
+     * @brief Remove all elements.
+     */
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+};
+
+#endif // BMP280_RING_BUFFER_HPP
@@ -0,0 +1,288 @@
+/**
+ * @file bmp280_sample_log.hpp
+ * @brief Compressed in-RAM log of raw samples.
+ */
+
+#ifndef BMP280_SAMPLE_LOG_HPP
+#define BMP280_SAMPLE_LOG_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bmp280_defs.hpp"
+#include "bmp280_compensation.hpp"
+
+/**
+ * @class bmp280_sample_log
+ * @brief Stores raw samples as zig-zag delta varints in fixed-size blocks.
+ *
+ * Consecutive raw readings differ by only a few LSB, so instead of 8 bytes per sample only the difference
+ * with the previous sample is stored. Differences are zig-zag encoded (0, -1, 1, -2, ... become 0, 1, 2, 3, ...)
+ * and written as varints, 7 bits per byte. Slow signals with little noise take about 1 byte per channel.
+ *
+ * Every block starts with a keyframe that holds the absolute values, so each block can be decoded on its own.
+ * When all blocks are full, the oldest block is reused. Samples are compensated lazily when they are read,
+ * with the calibration data stored in the log.
+ *
+ * @tparam block_size The number of data bytes per block.
+ * @tparam block_count The number of blocks.
+ **/
+template<size_t block_size, size_t block_count>
+class bmp280_sample_log {
+
+    static_assert(block_size >= 6, "a block must be able to hold at least one keyframe");
+    static_assert(block_size <= 0xFFFF, "the fill level of a block is stored in 16 bits");
+    static_assert(block_count >= 2, "the log needs at least two blocks to keep history when one is reused");
+
+private:
+    /**
+     * @struct block
+     * @brief A keyframe followed by delta encoded samples.
+     */
+    struct block {
+        uint32_t first_index;     /**< Index of the first sample in the block */
+        uint16_t used;            /**< Number of used data bytes */
+        uint16_t count;           /**< Number of samples in the block */
+        uint8_t data[block_size]; /**< Encoded samples */
+    };
+
+    bmp280_calibration_data calibration; /**< Calibration data used to compensate the samples */
+    block blocks[block_count];           /**< The blocks, used as a ring */
+    size_t oldest = 0;                   /**< Index of the oldest block */
+    size_t used_blocks = 0;              /**< Number of blocks that hold samples */
+    uint32_t next_index = 0;             /**< Index of the next sample */
+    bmp280_raw_sample last;              /**< Last appended sample, the reference for the next delta */
+
+    // Encodes a value as a varint, 7 bits per byte with the top bit set on all but the last byte
+    static size_t encodeVarint(uint32_t value, uint8_t* data) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            data[n++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        data[n++] = static_cast<uint8_t>(value);
+        return n;
+    }
+
+    static uint32_t decodeVarint(const uint8_t* data, size_t& position) {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = data[position++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    // Maps small positive and negative differences to small unsigned values
+    static uint32_t zigzag(int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    static int32_t unzigzag(uint32_t value) {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    // Decodes the next sample of a block, the first sample is the keyframe
+    static void decodeNext(const block& b, size_t& position, bool keyframe, bmp280_raw_sample& value) {
+        uint32_t t = decodeVarint(b.data, position);
+        uint32_t p = decodeVarint(b.data, position);
+        if (keyframe) {
+            value.temperature = t;
+            value.pressure = p;
+        } else {
+            value.temperature += unzigzag(t);
+            value.pressure += unzigzag(p);
+        }
+    }
+
+    block& newestBlock() {
+        return blocks[(oldest + used_blocks - 1) % block_count];
+    }
+
+    const block& getBlock(size_t n) const {
+        return blocks[(oldest + n) % block_count];
+    }
+
+    // Starts a new block, reusing the oldest block when all blocks are in use
+    block& startBlock() {
+        if (used_blocks < block_count) {
+            used_blocks++;
+        } else {
+            oldest = (oldest + 1) % block_count;
+        }
+        block& b = newestBlock();
+        b.first_index = next_index;
+        b.used = 0;
+        b.count = 0;
+        return b;
+    }
+
+public:
+    /**
+     * @brief Constructor for the bmp280_sample_log class.
+     * @param calibration The calibration data of the sensor the samples come from.
+     */
+    bmp280_sample_log(const bmp280_calibration_data& calibration) : calibration(calibration), last{0, 0} {}
+
+    /**
+     * @brief Add a raw sample to the log.
+     * @param raw The raw sample, as returned by bmp280::readSampleRaw().
+     */
+    void append(const bmp280_raw_sample& raw) {
+        // 20-bit values and their zig-zag encoded differences fit in 3 varint bytes each
+        uint8_t encoded[6];
+        size_t n = 0;
+
+        block* b = used_blocks == 0 ? &startBlock() : &newestBlock();
+        if (b->count > 0) {
+            n += encodeVarint(zigzag(static_cast<int32_t>(raw.temperature - last.temperature)), encoded + n);
+            n += encodeVarint(zigzag(static_cast<int32_t>(raw.pressure - last.pressure)), encoded + n);
+        }
+        if (b->count == 0 || b->used + n > block_size) {
+            if (b->count > 0) {
+                b = &startBlock();
+            }
+            n = encodeVarint(raw.temperature, encoded);
+            n += encodeVarint(raw.pressure, encoded + n);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            b->data[b->used + i] = encoded[i];
+        }
+        b->used += n;
+        b->count++;
+        next_index++;
+        last = raw;
+    }
+
+    /**
+     * @brief Get the number of samples in the log.
+     * @return The number of samples that can be read.
+     */
+    uint32_t size() const {
+        return used_blocks == 0 ? 0 : next_index - getBlock(0).first_index;
+    }
+
+    /**
+     * @brief Get the index of the oldest sample in the log.
+     *
+     * Sample indices count all samples ever appended, so they stay valid when old blocks are reused.
+     * @return The index of the oldest sample.
+     */
+    uint32_t firstIndex() const {
+        return used_blocks == 0 ? next_index : getBlock(0).first_index;
+    }
+
+    /**
+     * @brief Get the number of blocks that hold samples.
+     * @return The number of blocks, block 0 is the oldest.
+     */
+    size_t blocksUsed() const {
+        return used_blocks;
+    }
+
+    /**
+     * @brief Get the number of samples in a block.
+     * @param n The block number, 0 is the oldest.
+     * @return The number of samples in the block.
+     */
+    size_t blockSamples(size_t n) const {
+        return getBlock(n).count;
+    }
+
+    /**
+     * @brief Get the number of bytes used by the encoded samples.
+     * @return The number of used data bytes in all blocks.
+     */
+    size_t bytesUsed() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < used_blocks; i++) {
+            bytes += getBlock(i).used;
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief Decode all raw samples in a block.
+     * @param n The block number, 0 is the oldest.
+     * @param samples Receives the samples, must have room for blockSamples(n) samples.
+     * @return The number of decoded samples.
+     */
+    size_t readBlock(size_t n, bmp280_raw_sample* samples) const {
+        const block& b = getBlock(n);
+        size_t position = 0;
+        bmp280_raw_sample value = {0, 0};
+        for (size_t i = 0; i < b.count; i++) {
+            decodeNext(b, position, i == 0, value);
+            samples[i] = value;
+        }
+        return b.count;
+    }
+
+    /**
+     * @brief Decode and compensate all samples in a block.
+     * @param n The block number, 0 is the oldest.
+     * @param samples Receives the samples, must have room for blockSamples(n) samples.
+     * @return The number of decoded samples.
+     */
+    size_t readBlockCompensated(size_t n, bmp280_sample_int* samples) const {
+        const block& b = getBlock(n);
+        size_t position = 0;
+        bmp280_raw_sample value = {0, 0};
+        for (size_t i = 0; i < b.count; i++) {
+            decodeNext(b, position, i == 0, value);
+            int32_t t_fine;
+            samples[i].temperature = compensateTemperatureInt(calibration, value.temperature, t_fine);
+            samples[i].pressure = compensatePressureInt(calibration, value.pressure, t_fine);
+        }
+        return b.count;
+    }
+
+    /**
+     * @brief Decode a single raw sample.
+     *
+     * Only the block that holds the sample is decoded, up to the sample.
+     * @param index The sample index, between firstIndex() and firstIndex() + size().
+     * @param raw Receives the sample.
+     * @return False if the sample isn't in the log (anymore).
+     */
+    bool read(uint32_t index, bmp280_raw_sample& raw) const {
+        if (index < firstIndex() || index >= next_index) {
+            return false;
+        }
+
+        // Blocks hold consecutive indices, so the block is the last one that starts at or before the index
+        size_t n = used_blocks - 1;
+        while (getBlock(n).first_index > index) {
+            n--;
+        }
+
+        const block& b = getBlock(n);
+        size_t position = 0;
+        for (uint32_t i = b.first_index; i <= index; i++) {
+            decodeNext(b, position, i == b.first_index, raw);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decode and compensate a single sample.
+     * @param index The sample index, between firstIndex() and firstIndex() + size().
+     * @param sample Receives the temperature in 0.01 degrees Celsius and the pressure in Pa as Q24.8 fixed point.
+     * @return False if the sample isn't in the log (anymore).
+     */
+    bool readCompensated(uint32_t index, bmp280_sample_int& sample) const {
+        bmp280_raw_sample raw;
+        if (!read(index, raw)) {
+            return false;
+        }
+        int32_t t_fine;
+        sample.temperature = compensateTemperatureInt(calibration, raw.temperature, t_fine);
+        sample.pressure = compensatePressureInt(calibration, raw.pressure, t_fine);
+        return true;
+    }
+};
+
+#endif // BMP280_SAMPLE_LOG_HPP
@@ -0,0 +1,252 @@
+/**
+ * @file bmp280_scheduler.hpp
+ * @brief Periodic tasks against absolute deadlines, with statistics on how well they keep them.
+ *
+ * A loop that does its work and then waits for a fixed time drifts by the duration of the work, so its
+ * timestamps can't be used to calculate rates. The scheduler releases every task at start + n * period instead,
+ * so a late run doesn't delay the ones after it. Tasks run to completion, one at a time, in order of priority.
+ */
+
+#ifndef BMP280_SCHEDULER_HPP
+#define BMP280_SCHEDULER_HPP
+
+#include "hwlib.hpp"
+#include "bmp280_stats.hpp"
+
+/**
+ * @brief Task priorities, a lower value runs first when several tasks are due.
+ */
+enum task_priority {
+    PRIORITY_ACQUISITION = 0, /**< Reading sensors, late samples have wrong timestamps */
+    PRIORITY_DISPLAY = 1,     /**< Updating the display */
+    PRIORITY_LOGGING = 2      /**< Printing and other background work */
+};
+
+/**
+ * @class bmp280_task
+ * @brief Interface of the work done by a periodic task.
+ **/
+class bmp280_task {
+public:
+    /**
+     * @brief Destructor for the bmp280_task class, virtual so tasks can be deleted through the interface.
+     */
+    virtual ~bmp280_task() = default;
+
+    /**
+     * @brief Do the work of one period.
+     * @param release_us The time the task was due, use it as the timestamp instead of hwlib::now_us().
+     */
+    virtual void run(uint_fast64_t release_us) = 0;
+};
+
+/**
+ * @struct bmp280_task_stats
+ * @brief Struct that holds the timing statistics of a task.
+ */
+struct bmp280_task_stats {
+    uint32_t runs = 0;              /**< Number of times the task ran */
+    uint32_t missed = 0;            /**< Number of periods that were skipped because the task was a full period late */
+    bmp280_histogram execution;     /**< Duration of run() */
+    bmp280_histogram lateness;      /**< Time between the release and the start of run() */
+    bmp280_histogram jitter;        /**< Difference between the time between two starts and the period */
+};
+
+/**
+ * @class bmp280_scheduler
+ * @brief Runs periodic tasks at absolute deadlines, the task that is due with the highest priority first.
+ *
+ * Tasks can't be interrupted, so a long display update could make the next sample late. A task is therefore
+ * not started when a task with a higher priority is due before it would finish, judged by its longest
+ * execution time so far. This is skipped for a task that takes longer than the period of the other task,
+ * because it would never run otherwise.
+ * @tparam max_tasks The maximum number of tasks.
+ **/
+template<int max_tasks>
+class bmp280_scheduler {
+
+private:
+    /**
+     * @struct entry
+     * @brief A task and its schedule.
+     */
+    struct entry {
+        bmp280_task* task;            /**< The work */
+        const char* name;             /**< Name used by printStats() */
+        uint32_t period_us;           /**< Time between two releases */
+        task_priority priority;       /**< Priority */
+        uint32_t offset_us;           /**< Time of the first release after start() */
+        uint_fast64_t release_us;     /**< Time of the next release */
+        uint_fast64_t last_start_us;  /**< Start of the previous run */
+        uint32_t worst_us;            /**< Longest execution time, kept by resetStats() */
+        bmp280_task_stats stats;      /**< Timing statistics */
+    };
+
+    entry tasks[max_tasks];  /**< The tasks */
+    int task_count = 0;      /**< Number of tasks */
+
+    // hwlib::wait_us() takes a signed 32-bit time, so a long wait is cut short and runNext() looks again
+    static void waitFor(uint_fast64_t duration_us) {
+        const uint_fast64_t longest_us = 1000000000;
+        hwlib::wait_us(static_cast<int_fast32_t>(duration_us < longest_us ? duration_us : longest_us));
+    }
+
+    // Runs the task and moves its release to the next period that is still in the future
+    void dispatch(entry& task, uint_fast64_t now) {
+        if (task.stats.runs > 0) {
+            int64_t interval = static_cast<int64_t>(now - task.last_start_us) - task.period_us;
+            task.stats.jitter.add(static_cast<uint32_t>(interval < 0 ? -interval : interval));
+        }
+        task.stats.lateness.add(static_cast<uint32_t>(now - task.release_us));
+        task.last_start_us = now;
+
+        task.task->run(task.release_us);
+
+        uint_fast64_t end = hwlib::now_us();
+        uint32_t duration_us = static_cast<uint32_t>(end - now);
+        task.stats.execution.add(duration_us);
+        task.worst_us = duration_us > task.worst_us ? duration_us : task.worst_us;
+        task.stats.runs++;
+
+        task.release_us += task.period_us;
+        if (task.release_us + task.period_us <= end) {
+            uint32_t skipped = static_cast<uint32_t>((end - task.release_us) / task.period_us);
+            task.release_us += static_cast<uint_fast64_t>(skipped) * task.period_us;
+            task.stats.missed += skipped;
+        }
+    }
+
+public:
+    /**
+     * @brief Add a task.
+     * @param task The work to do.
+     * @param name The name to print with the statistics.
+     * @param period_us The time between two runs.
+     * @param priority The priority.
+     * @param offset_us The time of the first run after start(), to spread tasks with the same period.
+     * @return False if there is no room for another task.
+     */
+    bool add(bmp280_task& task, const char* name, uint32_t period_us, task_priority priority, uint32_t offset_us = 0) {
+        if (task_count == max_tasks || period_us == 0) {
+            return false;
+        }
+        entry& added = tasks[task_count++];
+        added.task = &task;
+        added.name = name;
+        added.period_us = period_us;
+        added.priority = priority;
+        added.offset_us = offset_us;
+        added.release_us = 0;
+        added.last_start_us = 0;
+        added.worst_us = 0;
+        return true;
+    }
+
+    /**
+     * @brief Release every task for the first time, at its offset from now.
+     */
+    void start() {
+        uint_fast64_t now = hwlib::now_us();
+        for (int i = 0; i < task_count; i++) {
+            tasks[i].release_us = now + tasks[i].offset_us;
+        }
+    }
+
+    /**
+     * @brief Wait for the next task that may run, and run it.
+     * @return False if there are no tasks.
+     */
+    bool runNext() {
+        if (task_count == 0) {
+            return false;
+        }
+
+        while (true) {
+            uint_fast64_t now = hwlib::now_us();
+
+            // The due task with the highest priority, the one that is due the longest first
+            entry* next = nullptr;
+            uint_fast64_t earliest_us = tasks[0].release_us;
+            for (int i = 0; i < task_count; i++) {
+                entry& task = tasks[i];
+                earliest_us = task.release_us < earliest_us ? task.release_us : earliest_us;
+                if (task.release_us <= now && (next == nullptr || task.priority < next->priority
+                    || (task.priority == next->priority && task.release_us < next->release_us))) {
+                    next = &task;
+                }
+            }
+            if (next == nullptr) {
+                waitFor(earliest_us - now);
+                continue;
+            }
+
+            // Don't start it if it would still be running when a more important task is due
+            uint_fast64_t blocked_until_us = 0;
+            uint32_t duration_us = next->worst_us;
+            for (int i = 0; i < task_count; i++) {
+                entry& task = tasks[i];
+                if (task.priority < next->priority && duration_us < task.period_us
+                    && task.release_us < now + duration_us && task.release_us > blocked_until_us) {
+                    blocked_until_us = task.release_us;
+                }
+            }
+            if (blocked_until_us > now) {
+                waitFor(blocked_until_us - now);
+                continue;
+            }
+
+            dispatch(*next, now);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Run the tasks forever.
+     */
+    void run() {
+        while (runNext()) {}
+    }
+
+    /**
+     * @brief Get the number of tasks.
+     * @return The number of tasks that were added.
+     */
+    int getTaskCount() const {
+        return task_count;
+    }
+
+    /**
+     * @brief Get the timing statistics of a task.
+     * @param index The task, in the order they were added.
+     * @return The statistics.
+     */
+    const bmp280_task_stats& getStats(int index) const {
+        return tasks[index].stats;
+    }
+
+    /**
+     * @brief Clear the timing statistics of all tasks.
+     *
+     * The longest execution times that decide whether a task may start are kept.
+     */
+    void resetStats() {
+        for (int i = 0; i < task_count; i++) {
+            tasks[i].stats = bmp280_task_stats();
+        }
+    }
+
+    /**
+     * @brief Print the timing statistics of all tasks.
+     */
+    void printStats() const {
+        for (int i = 0; i < task_count; i++) {
+            const entry& task = tasks[i];
+            hwlib::cout << task.name << ": " << task.stats.runs << " runs, " << task.stats.missed << " missed" << hwlib::endl;
+            task.stats.execution.print("execution time");
+            task.stats.lateness.print("lateness");
+            task.stats.jitter.print("period jitter");
+        }
+    }
+};
+
+#endif // BMP280_SCHEDULER_HPP
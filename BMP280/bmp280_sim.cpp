@@ -0,0 +1,354 @@
+#include "bmp280_sim.hpp"
+#include <math.h>
+
+const bmp280_calibration_data bmp280_sim::example_calibration = {
+    27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000, 0
+};
+
+// H4 = 313 and H5 = 50 are stored as 12-bit values, see Chapter 4.2.2 of the BME280 datasheet
+const bme280_humidity_calibration bmp280_sim::example_humidity_calibration = {
+    75, 362, 0, 313, 50, 30
+};
+
+// The NVM holds the calibration data as little endian 16-bit words from 0x88, see Chapter 3.11.2 of the datasheet
+bmp280_sim::bmp280_sim(const bmp280_calibration_data& calibration) :
+    temperature{519888, 0, 0, 0}, pressure{415148, 0, 0, 0}, humidity{28000, 0, 0, 0}, chip_id(BMP280_CHIP_ID),
+    ctrl_hum_active(0), random_state(1), conversion_count(0)
+{
+    const uint16_t words[] = {
+        calibration.dig_T1, static_cast<uint16_t>(calibration.dig_T2), static_cast<uint16_t>(calibration.dig_T3),
+        calibration.dig_P1, static_cast<uint16_t>(calibration.dig_P2), static_cast<uint16_t>(calibration.dig_P3),
+        static_cast<uint16_t>(calibration.dig_P4), static_cast<uint16_t>(calibration.dig_P5),
+        static_cast<uint16_t>(calibration.dig_P6), static_cast<uint16_t>(calibration.dig_P7),
+        static_cast<uint16_t>(calibration.dig_P8), static_cast<uint16_t>(calibration.dig_P9)
+    };
+    for (int reg = 0; reg < 256; reg++) {
+        registers[reg] = 0;
+    }
+    for (int i = 0; i < 12; i++) {
+        registers[BMP280_DIG_T1_REG + 2 * i] = words[i] & 0xFF;
+        registers[BMP280_DIG_T1_REG + 2 * i + 1] = words[i] >> 8;
+    }
+    reset();
+}
+
+void bmp280_sim::enableHumidity(const bme280_humidity_calibration& calibration) {
+    chip_id = BME280_CHIP_ID;
+    registers[BMP280_CHIP_ID_REG] = BME280_CHIP_ID;
+    registers[BME280_DIG_H1_REG] = calibration.dig_H1;
+    registers[BME280_DIG_H2_REG] = static_cast<uint16_t>(calibration.dig_H2) & 0xFF;
+    registers[BME280_DIG_H2_REG + 1] = static_cast<uint16_t>(calibration.dig_H2) >> 8;
+    registers[BME280_DIG_H2_REG + 2] = calibration.dig_H3;
+    registers[BME280_DIG_H2_REG + 3] = static_cast<uint8_t>(calibration.dig_H4 >> 4);
+    registers[BME280_DIG_H2_REG + 4] = static_cast<uint8_t>((calibration.dig_H4 & 0x0F) | ((calibration.dig_H5 & 0x0F) << 4));
+    registers[BME280_DIG_H2_REG + 5] = static_cast<uint8_t>(calibration.dig_H5 >> 4);
+    registers[BME280_DIG_H2_REG + 6] = static_cast<uint8_t>(calibration.dig_H6);
+}
+
+// Power-on reset values from Table 18 of the datasheet, the NVM isn't affected
+void bmp280_sim::reset() {
+    registers[BMP280_CHIP_ID_REG] = chip_id;
+    registers[BME280_CTRL_HUM_REG] = 0x00;
+    registers[BME280_HUM_DATA_REG] = 0x80;
+    registers[BME280_HUM_DATA_REG + 1] = 0x00;
+    ctrl_hum_active = 0;
+    registers[BMP280_RESET_REG] = 0x00;
+    registers[BMP280_STATUS_REG] = 0x00;
+    registers[BMP280_CTRL_REG] = 0x00;
+    registers[BMP280_CONFIG_REG] = 0x00;
+    const uint8_t data[] = {0x80, 0x00, 0x00, 0x80, 0x00, 0x00};
+    for (int i = 0; i < BMP280_DATA_LENGTH; i++) {
+        registers[BMP280_PRESS_DATA_REG + i] = data[i];
+    }
+    converting = false;
+    conversion_end_us = 0;
+    filter_primed = false;
+}
+
+void bmp280_sim::setTemperatureWaveform(const bmp280_sim_waveform& waveform) {
+    temperature = waveform;
+}
+
+void bmp280_sim::setPressureWaveform(const bmp280_sim_waveform& waveform) {
+    pressure = waveform;
+}
+
+void bmp280_sim::setHumidityWaveform(const bmp280_sim_waveform& waveform) {
+    humidity = waveform;
+}
+
+uint32_t bmp280_sim::typicalMeasurementTime() const {
+    sampling_config osrs_t = static_cast<sampling_config>((registers[BMP280_CTRL_REG] >> 5) & 0b111);
+    sampling_config osrs_p = static_cast<sampling_config>((registers[BMP280_CTRL_REG] >> 2) & 0b111);
+    return typicalMeasurementTimeUs(osrs_t, osrs_p, static_cast<sampling_config>(ctrl_hum_active));
+}
+
+uint32_t bmp280_sim::standbyTime() const {
+    return standbyTimeUs(static_cast<standby_config>(registers[BMP280_CONFIG_REG] >> 5), chip_id);
+}
+
+uint32_t bmp280_sim::sampleWaveform(const bmp280_sim_waveform& waveform, uint_fast64_t time_us) {
+    double value = waveform.base;
+    if (waveform.period_us != 0) {
+        value += waveform.amplitude * sin(2 * M_PI * static_cast<double>(time_us % waveform.period_us) / waveform.period_us);
+    }
+    if (waveform.noise != 0) {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        value += static_cast<int32_t>(random_state % (2 * waveform.noise + 1)) - static_cast<int32_t>(waveform.noise);
+    }
+    if (value < 0) {
+        value = 0;
+    }
+    return value > 0xFFFFF ? 0xFFFFF : static_cast<uint32_t>(value);
+}
+
+// Stores the result of a conversion in the data registers
+void bmp280_sim::finishConversion(uint_fast64_t time_us) {
+    uint8_t ctrl_meas = registers[BMP280_CTRL_REG];
+    sampling_config osrs_t = static_cast<sampling_config>((ctrl_meas >> 5) & 0b111);
+    sampling_config osrs_p = static_cast<sampling_config>((ctrl_meas >> 2) & 0b111);
+    uint8_t filter = (registers[BMP280_CONFIG_REG] >> 2) & 0b111;
+
+    // Resolution is 16 bits at x1 and one more bit for every doubling, Chapter 3.3.1 and 3.3.2 of the datasheet
+    uint32_t raw_temp = sampleWaveform(temperature, time_us) & (0xFFFFFu << (osrs_t == SAMPLING_NONE ? 0 : 5 - osrs_t) & 0xFFFFF);
+    uint32_t raw_press = sampleWaveform(pressure, time_us) & (0xFFFFFu << (osrs_p == SAMPLING_NONE ? 0 : 5 - osrs_p) & 0xFFFFF);
+
+    // With the filter on, the results have 20 bits of resolution, see Chapter 3.3.3 of the datasheet
+    if (filter == FILTER_OFF || !filter_primed) {
+        filtered_temperature = raw_temp;
+        filtered_pressure = raw_press;
+        filter_primed = true;
+    } else {
+        uint32_t coefficient = 1u << filter;
+        filtered_temperature = (filtered_temperature * (coefficient - 1) + raw_temp) / coefficient;
+        filtered_pressure = (filtered_pressure * (coefficient - 1) + raw_press) / coefficient;
+    }
+
+    // Skipped measurements read as 0x80000
+    uint32_t out_temp = osrs_t == SAMPLING_NONE ? 0x80000 : filtered_temperature;
+    uint32_t out_press = osrs_p == SAMPLING_NONE ? 0x80000 : filtered_pressure;
+    registers[0xF7] = out_press >> 12;
+    registers[0xF8] = (out_press >> 4) & 0xFF;
+    registers[0xF9] = (out_press << 4) & 0xF0;
+    registers[0xFA] = out_temp >> 12;
+    registers[0xFB] = (out_temp >> 4) & 0xFF;
+    registers[0xFC] = (out_temp << 4) & 0xF0;
+
+    // Humidity has 16 bits and no IIR filter, Chapter 3.4.3 of the BME280 datasheet
+    if (chip_id == BME280_CHIP_ID) {
+        uint32_t raw_hum = ctrl_hum_active == SAMPLING_NONE ? BME280_RAW_HUMIDITY_SKIPPED : sampleWaveform(humidity, time_us);
+        raw_hum = raw_hum > 0xFFFF ? 0xFFFF : raw_hum;
+        registers[BME280_HUM_DATA_REG] = raw_hum >> 8;
+        registers[BME280_HUM_DATA_REG + 1] = raw_hum & 0xFF;
+    }
+    conversion_count++;
+}
+
+void bmp280_sim::update() {
+    uint_fast64_t now = hwlib::now_us();
+    uint8_t mode = registers[BMP280_CTRL_REG] & 0b11;
+
+    if (mode == FORCED_MODE || mode == 0x01) {
+        if (converting && now >= conversion_end_us) {
+            finishConversion(conversion_end_us);
+            converting = false;
+
+            // After a forced conversion the sensor returns to sleep mode, Chapter 3.6.2 of the datasheet
+            registers[BMP280_CTRL_REG] &= ~(0b11);
+        }
+    } else if (mode == NORMAL_MODE) {
+        // Normal mode converts continuously, with the standby time between conversions
+        uint32_t period = typicalMeasurementTime() + standbyTime();
+
+        // Skip conversions nobody could have read, only the last few matter for the filter
+        if (now >= conversion_end_us + 64 * static_cast<uint_fast64_t>(period)) {
+            conversion_end_us += ((now - conversion_end_us) / period - 16) * period;
+        }
+        while (now >= conversion_end_us) {
+            finishConversion(conversion_end_us);
+            conversion_end_us += period;
+        }
+        converting = now + typicalMeasurementTime() >= conversion_end_us;
+    } else {
+        converting = false;
+    }
+
+    registers[BMP280_STATUS_REG] = converting ? BMP280_STATUS_MEASURING : 0x00;
+}
+
+uint8_t bmp280_sim::readRegister(uint8_t reg) {
+    update();
+    return registers[reg];
+}
+
+void bmp280_sim::writeRegister(uint8_t reg, uint8_t value) {
+    update();
+    uint_fast64_t now = hwlib::now_us();
+
+    if (reg == BMP280_RESET_REG) {
+        // Only the value 0xB6 resets the sensor, Chapter 4.3.2 of the datasheet
+        if (value == 0xB6) {
+            reset();
+        }
+    } else if (reg == BME280_CTRL_HUM_REG) {
+        if (chip_id == BME280_CHIP_ID) {
+            registers[BME280_CTRL_HUM_REG] = value & 0b111;
+        }
+    } else if (reg == BMP280_CTRL_REG) {
+        // A change of ctrl_hum only takes effect after a write to ctrl_meas, Chapter 5.4.3 of the BME280 datasheet
+        ctrl_hum_active = registers[BME280_CTRL_HUM_REG];
+        uint8_t old_mode = registers[BMP280_CTRL_REG] & 0b11;
+        registers[BMP280_CTRL_REG] = value;
+        uint8_t mode = value & 0b11;
+
+        if ((mode == FORCED_MODE || mode == 0x01) && !converting) {
+            converting = true;
+            conversion_end_us = now + typicalMeasurementTime();
+        } else if (mode == NORMAL_MODE && old_mode != NORMAL_MODE) {
+            converting = true;
+            conversion_end_us = now + typicalMeasurementTime();
+        }
+        registers[BMP280_STATUS_REG] = converting ? BMP280_STATUS_MEASURING : 0x00;
+    } else if (reg == BMP280_CONFIG_REG) {
+        // Writes to config in normal mode may be ignored, Chapter 3.6.3 of the datasheet
+        if ((registers[BMP280_CTRL_REG] & 0b11) != NORMAL_MODE) {
+            if (((value >> 2) & 0b111) != ((registers[BMP280_CONFIG_REG] >> 2) & 0b111)) {
+                filter_primed = false;
+            }
+            registers[BMP280_CONFIG_REG] = value;
+        }
+    }
+}
+
+uint32_t bmp280_sim::conversions() const {
+    return conversion_count;
+}
+
+bmp280_sim_i2c_bus::bmp280_sim_i2c_bus(bmp280_sim& sensor, uint8_t i2c_address) :
+    sensor(sensor), i2c_address(i2c_address), state(IDLE), selected(false), pointer(0),
+    transaction_count(0), byte_count(0)
+{}
+
+void bmp280_sim_i2c_bus::write_start() {
+    state = ADDRESS;
+    transaction_count++;
+}
+
+void bmp280_sim_i2c_bus::write_stop() {
+    state = IDLE;
+    selected = false;
+}
+
+void bmp280_sim_i2c_bus::write_ack() {}
+
+void bmp280_sim_i2c_bus::write_nack() {}
+
+// The sensor only acknowledges transactions addressed to it
+bool bmp280_sim_i2c_bus::read_ack() {
+    return selected;
+}
+
+void bmp280_sim_i2c_bus::write_byte(uint8_t x) {
+    byte_count++;
+    switch (state) {
+        case ADDRESS:
+            selected = (x >> 1) == i2c_address;
+            state = (x & 0x01) ? READ : REGISTER;
+            break;
+        case REGISTER:
+            pointer = x;
+            state = DATA;
+            break;
+        case DATA:
+            // Writes consist of register address and value pairs, Chapter 5.2.1 of the datasheet
+            if (selected) {
+                sensor.writeRegister(pointer, x);
+            }
+            state = REGISTER;
+            break;
+        default:
+            break;
+    }
+}
+
+// Reads auto-increment the register address, Chapter 5.2.2 of the datasheet
+uint8_t bmp280_sim_i2c_bus::read_byte() {
+    byte_count++;
+    if (!selected || state != READ) {
+        return 0xFF;
+    }
+    return sensor.readRegister(pointer++);
+}
+
+uint32_t bmp280_sim_i2c_bus::transactions() const {
+    return transaction_count;
+}
+
+uint32_t bmp280_sim_i2c_bus::bytes() const {
+    return byte_count;
+}
+
+void bmp280_sim_i2c_bus::resetCounters() {
+    transaction_count = 0;
+    byte_count = 0;
+}
+
+bmp280_sim_spi_bus::bmp280_sim_spi_bus(bmp280_sim& sensor) :
+    sensor(sensor), chip_select(*this), state(IDLE), pointer(0), transaction_count(0), byte_count(0)
+{}
+
+// Chip select is active low, a frame starts with a control byte
+void bmp280_sim_spi_bus::chip_select_pin::write(bool x) {
+    if (!x && bus.state == IDLE) {
+        bus.state = CONTROL;
+        bus.transaction_count++;
+    } else if (x) {
+        bus.state = IDLE;
+    }
+}
+
+void bmp280_sim_spi_bus::write_and_read(const size_t n, const uint8_t data_out[], uint8_t data_in[]) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t out = data_out != nullptr ? data_out[i] : 0;
+        uint8_t in = 0xFF;
+        byte_count++;
+        switch (state) {
+            case CONTROL:
+                // Only bits 6..0 are sent, bit 7 of the register address is always 1 (Chapter 5.3)
+                pointer = out | 0x80;
+                state = (out & 0x80) ? READ : DATA;
+                break;
+            case DATA:
+                sensor.writeRegister(pointer, out);
+                state = CONTROL;
+                break;
+            case READ:
+                in = sensor.readRegister(pointer++);
+                break;
+            default:
+                break;
+        }
+        if (data_in != nullptr) {
+            data_in[i] = in;
+        }
+    }
+}
+
+hwlib::pin_out& bmp280_sim_spi_bus::chipSelect() {
+    return chip_select;
+}
+
+uint32_t bmp280_sim_spi_bus::transactions() const {
+    return transaction_count;
+}
+
+uint32_t bmp280_sim_spi_bus::bytes() const {
+    return byte_count;
+}
+
+void bmp280_sim_spi_bus::resetCounters() {
+    transaction_count = 0;
+    byte_count = 0;
+}
@@ -0,0 +1,256 @@
+/**
+ * @file bmp280_sim.hpp
+ * @brief Simulated BMP280 for running the driver without a sensor attached.
+ */
+
+#ifndef BMP280_SIM_HPP
+#define BMP280_SIM_HPP
+
+#include "hwlib.hpp"
+#include "bmp280_defs.hpp"
+
+/**
+ * @struct bmp280_sim_waveform
+ * @brief Struct that describes the raw values a simulated sensor produces for one channel.
+ *
+ * The raw value at time t is base + amplitude * sin(2 * pi * t / period_us) plus uniform noise of +/- noise.
+ */
+typedef struct {
+    uint32_t base;      /**< Raw 20-bit value around which the waveform moves */
+    int32_t amplitude;  /**< Amplitude of the sine wave in raw LSB */
+    uint32_t period_us; /**< Period of the sine wave in microseconds, 0 for a constant value */
+    uint32_t noise;     /**< Maximum noise in raw LSB */
+} bmp280_sim_waveform;
+
+/**
+ * @class bmp280_sim
+ * @brief Register level model of a BMP280.
+ *
+ * The model has the calibration NVM, the chip ID and reset registers, and the ctrl_meas, config and status
+ * semantics. Forced and normal mode conversions take the typical measurement time from Chapter 3.8.1 of the
+ * datasheet. Oversampling sets the resolution of the results, and the IIR filter is applied as described in
+ * Chapter 3.3.3. Time comes from hwlib::now_us(), so the driver's own timing is exercised as well.
+ *
+ * After enableHumidity() the model is a BME280: it has chip ID 0x60, the humidity calibration NVM, ctrl_hum,
+ * which takes effect on the next write to ctrl_meas, and the humidity data registers 0xFD..0xFE.
+ *
+ * The model is accessed through a bus front end such as bmp280_sim_i2c_bus.
+ **/
+class bmp280_sim {
+
+private:
+    uint8_t registers[256];          /**< Register map */
+    bmp280_sim_waveform temperature; /**< Raw temperature waveform */
+    bmp280_sim_waveform pressure;    /**< Raw pressure waveform */
+    bmp280_sim_waveform humidity;    /**< Raw humidity waveform, only used as a BME280 */
+    uint8_t chip_id;                 /**< BMP280_CHIP_ID or BME280_CHIP_ID */
+    uint8_t ctrl_hum_active;         /**< Humidity oversampling, copied from ctrl_hum on a write to ctrl_meas */
+    uint32_t random_state;           /**< State of the noise generator */
+
+    bool converting;                 /**< True while a conversion is running */
+    uint_fast64_t conversion_end_us; /**< Time at which the running or next conversion is done */
+    uint32_t filtered_temperature;   /**< Output of the IIR filter for temperature */
+    uint32_t filtered_pressure;      /**< Output of the IIR filter for pressure */
+    bool filter_primed;              /**< False until the first conversion after a reset or filter change */
+
+    uint32_t conversion_count;       /**< Number of finished conversions */
+
+    uint32_t typicalMeasurementTime() const;
+    uint32_t standbyTime() const;
+    uint32_t sampleWaveform(const bmp280_sim_waveform& waveform, uint_fast64_t time_us);
+    void finishConversion(uint_fast64_t time_us);
+
+public:
+    /**
+     * @brief Constructor for the bmp280_sim class.
+     * @param calibration The calibration data to put in the NVM, the example from Chapter 3.12 of the datasheet by default.
+     */
+    bmp280_sim(const bmp280_calibration_data& calibration = example_calibration);
+
+    /**
+     * @brief The calibration data of the example in Chapter 3.12 of the datasheet.
+     */
+    static const bmp280_calibration_data example_calibration;
+
+    /**
+     * @brief Humidity calibration data of a typical BME280.
+     */
+    static const bme280_humidity_calibration example_humidity_calibration;
+
+    /**
+     * @brief Turn the model into a BME280.
+     * @param calibration The humidity calibration data to put in the NVM.
+     */
+    void enableHumidity(const bme280_humidity_calibration& calibration = example_humidity_calibration);
+
+    /**
+     * @brief Put all registers in their power-on reset state.
+     */
+    void reset();
+
+    /**
+     * @brief Set the waveform of the raw temperature.
+     * @param waveform The waveform, in raw 20-bit LSB.
+     */
+    void setTemperatureWaveform(const bmp280_sim_waveform& waveform);
+
+    /**
+     * @brief Set the waveform of the raw pressure.
+     * @param waveform The waveform, in raw 20-bit LSB.
+     */
+    void setPressureWaveform(const bmp280_sim_waveform& waveform);
+
+    /**
+     * @brief Set the waveform of the raw humidity, only used as a BME280.
+     * @param waveform The waveform, in raw 16-bit LSB.
+     */
+    void setHumidityWaveform(const bmp280_sim_waveform& waveform);
+
+    /**
+     * @brief Finish any conversions that should be done by now.
+     */
+    void update();
+
+    /**
+     * @brief Read a register, as the sensor would on the bus.
+     * @param reg The register address.
+     * @return The register value.
+     */
+    uint8_t readRegister(uint8_t reg);
+
+    /**
+     * @brief Write a register, as the sensor would on the bus.
+     * @param reg The register address.
+     * @param value The value to write, writes to read-only registers are ignored.
+     */
+    void writeRegister(uint8_t reg, uint8_t value);
+
+    /**
+     * @brief Get the number of finished conversions.
+     * @return The number of conversions since construction.
+     */
+    uint32_t conversions() const;
+};
+
+/**
+ * @class bmp280_sim_i2c_bus
+ * @brief hwlib i2c bus with a simulated BMP280 attached.
+ *
+ * Decodes the I2C primitives the way the sensor does (Chapter 5.2 of the datasheet): a write transaction
+ * consists of register address and value pairs, and a read transaction reads from the register address
+ * that was written last, auto-incrementing after every byte. Transactions and bytes are counted, so bus
+ * usage of the driver can be measured.
+ **/
+class bmp280_sim_i2c_bus : public hwlib::i2c_bus {
+
+private:
+    bmp280_sim& sensor;   /**< The simulated sensor */
+    uint8_t i2c_address;  /**< The i2c slave address of the simulated sensor */
+
+    enum { IDLE, ADDRESS, REGISTER, DATA, READ } state; /**< Position within the current transaction */
+    bool selected;        /**< True if the current transaction is addressed to the sensor */
+    uint8_t pointer;      /**< Register address for the next read or write */
+
+    uint32_t transaction_count; /**< Number of started transactions */
+    uint32_t byte_count;        /**< Number of bytes on the bus, including address bytes */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_sim_i2c_bus class.
+     * @param sensor The simulated sensor.
+     * @param i2c_address The i2c slave address the sensor answers to. Default is 0x76.
+     */
+    bmp280_sim_i2c_bus(bmp280_sim& sensor, uint8_t i2c_address = 0x76);
+
+    void write_start() override;
+    void write_stop() override;
+    void write_ack() override;
+    void write_nack() override;
+    bool read_ack() override;
+    void write_byte(uint8_t x) override;
+    uint8_t read_byte() override;
+
+    /**
+     * @brief Get the number of transactions since the last resetCounters().
+     * @return The number of transactions.
+     */
+    uint32_t transactions() const;
+
+    /**
+     * @brief Get the number of bytes on the bus since the last resetCounters().
+     * @return The number of bytes, including the address byte of each transaction.
+     */
+    uint32_t bytes() const;
+
+    /**
+     * @brief Reset the transaction and byte counters.
+     */
+    void resetCounters();
+};
+
+/**
+ * @class bmp280_sim_spi_bus
+ * @brief hwlib spi bus with a simulated BMP280 attached.
+ *
+ * Decodes the SPI frames the way the sensor does (Chapter 5.3 of the datasheet). The first byte after chip select
+ * goes low is a control byte: with bit 7 set the following bytes read from that register onwards, otherwise the
+ * frame consists of register address and value pairs with bit 7 cleared. Transactions and bytes are counted.
+ **/
+class bmp280_sim_spi_bus : public hwlib::spi_bus {
+
+private:
+    /**
+     * @class chip_select_pin
+     * @brief The CSB pin of the simulated sensor, frames start and end when it changes.
+     */
+    class chip_select_pin : public hwlib::pin_out {
+        bmp280_sim_spi_bus& bus;
+    public:
+        chip_select_pin(bmp280_sim_spi_bus& bus) : bus(bus) {}
+        void write(bool x) override;
+        void flush() override {}
+    };
+
+    bmp280_sim& sensor;            /**< The simulated sensor */
+    chip_select_pin chip_select;   /**< CSB pin of the sensor */
+
+    enum { IDLE, CONTROL, DATA, READ } state; /**< Position within the current frame */
+    uint8_t pointer;               /**< Register address for the next read or write */
+
+    uint32_t transaction_count;    /**< Number of frames */
+    uint32_t byte_count;           /**< Number of bytes transferred */
+
+    void write_and_read(const size_t n, const uint8_t data_out[], uint8_t data_in[]) override;
+
+public:
+    /**
+     * @brief Constructor for the bmp280_sim_spi_bus class.
+     * @param sensor The simulated sensor.
+     */
+    bmp280_sim_spi_bus(bmp280_sim& sensor);
+
+    /**
+     * @brief Get the chip select pin of the simulated sensor, to pass to bmp280_spi_transport.
+     * @return The chip select pin.
+     */
+    hwlib::pin_out& chipSelect();
+
+    /**
+     * @brief Get the number of transactions since the last resetCounters().
+     * @return The number of transactions.
+     */
+    uint32_t transactions() const;
+
+    /**
+     * @brief Get the number of bytes on the bus since the last resetCounters().
+     * @return The number of bytes, including the control byte of each transaction.
+     */
+    uint32_t bytes() const;
+
+    /**
+     * @brief Reset the transaction and byte counters.
+     */
+    void resetCounters();
+};
+
+#endif // BMP280_SIM_HPP
@@ -0,0 +1,65 @@
+/**
+ * @file bmp280_static.hpp
+ * @brief BMP280 driver with a configuration that is fixed at compile time.
+ */
+
+#ifndef BMP280_STATIC_HPP
+#define BMP280_STATIC_HPP
+
+#include "bmp280.hpp"
+
+/**
+ * @class bmp280_static
+ * @brief BMP280 driver whose ctrl_meas and config registers are computed at compile time.
+ *
+ * setup() of bmp280 applies its configuration one setting at a time. This variant writes the
+ * precomputed register values in a single transaction and has no runtime configuration logic. Invalid configurations are rejected when the template is instantiated.
+ *
+ * Example:
+ * @code
+ * bmp280_static<SAMPLING_X2, SAMPLING_X16, FILTER_X16, STANDBY_MS_1, NORMAL_MODE> sensor(i2c_bus);
+ * sensor.setup();
+ * @endcode
+ *
+ * @tparam osrs_t The oversampling setting for temperature.
+ * @tparam osrs_p The oversampling setting for pressure.
+ * @tparam filter The IIR filter coefficient.
+ * @tparam standby The standby time in normal mode.
+ * @tparam mode The power mode.
+ **/
+template<sampling_config osrs_t, sampling_config osrs_p, filter_config filter,
+         standby_config standby = STANDBY_MS_1, power_modes mode = FORCED_MODE>
+class bmp280_static : public bmp280 {
+
+    static_assert(osrs_t <= SAMPLING_X16, "invalid temperature oversampling setting");
+    static_assert(osrs_p <= SAMPLING_X16, "invalid pressure oversampling setting");
+    static_assert(filter <= FILTER_X16, "invalid filter setting");
+    static_assert(standby <= STANDBY_MS_4000, "invalid standby setting");
+    static_assert(mode == SLEEP_MODE || mode == FORCED_MODE || mode == NORMAL_MODE, "invalid power mode");
+    static_assert(osrs_t != SAMPLING_NONE || osrs_p == SAMPLING_NONE,
+                  "pressure compensation needs the temperature of the same conversion, so it can't be skipped");
+    static_assert(mode == SLEEP_MODE || osrs_t != SAMPLING_NONE,
+                  "a measurement mode needs at least one measurement enabled");
+
+public:
+    /**
+     * @brief Value of the ctrl_meas register.
+     */
+    static constexpr uint8_t ctrl_meas = makeCtrlMeas(osrs_t, osrs_p, mode);
+
+    /**
+     * @brief Value of the config register.
+     */
+    static constexpr uint8_t config = makeConfig(standby, filter);
+
+    using bmp280::bmp280;
+
+    /**
+     * @brief Setup the sensor by writing both configuration registers in a single transaction.
+     */
+    void setup() {
+        writeConfiguration(ctrl_meas, config);
+    }
+};
+
+#endif // BMP280_STATIC_HPP
@@ -0,0 +1,73 @@
+#include "bmp280_stats.hpp"
+
+bmp280_histogram::bmp280_histogram() {
+    clear();
+}
+
+void bmp280_histogram::clear() {
+    count = 0;
+    minimum = 0;
+    maximum = 0;
+    total = 0;
+    for (int i = 0; i < bucket_count; i++) {
+        buckets[i] = 0;
+    }
+}
+
+void bmp280_histogram::add(uint32_t duration_us) {
+    if (count == 0 || duration_us < minimum) {
+        minimum = duration_us;
+    }
+    if (duration_us > maximum) {
+        maximum = duration_us;
+    }
+    total += duration_us;
+    count++;
+
+    // The bucket is the number of significant bits of the duration
+    int bucket = 0;
+    while (duration_us != 0 && bucket < bucket_count - 1) {
+        duration_us >>= 1;
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+uint32_t bmp280_histogram::getCount() const {
+    return count;
+}
+
+uint32_t bmp280_histogram::getMinimum() const {
+    return minimum;
+}
+
+uint32_t bmp280_histogram::getMaximum() const {
+    return maximum;
+}
+
+uint32_t bmp280_histogram::getMean() const {
+    return count == 0 ? 0 : static_cast<uint32_t>(total / count);
+}
+
+uint32_t bmp280_histogram::getBucket(int bucket) const {
+    return buckets[bucket];
+}
+
+void bmp280_histogram::print(const char* name) const {
+    hwlib::cout << name << ":" << hwlib::dec << hwlib::endl;
+    hwlib::cout << "count: " << count << ", min: " << minimum << " us, max: " << maximum << " us, mean: " << getMean() << " us" << hwlib::endl;
+    for (int i = 0; i < bucket_count; i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        if (i == 0) {
+            hwlib::cout << "      < 1 us: ";
+        } else if (i == bucket_count - 1) {
+            hwlib::cout << ">= " << hwlib::setw(6) << hwlib::setfill(' ') << (1u << (i - 1)) << " us: ";
+        } else {
+            hwlib::cout << "<  " << hwlib::setw(6) << hwlib::setfill(' ') << (1u << i) << " us: ";
+        }
+        hwlib::cout << buckets[i] << hwlib::endl;
+    }
+    hwlib::cout << hwlib::endl;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file bmp280_stats.hpp
+ * @brief Optional instrumentation of the time the driver spends on the bus and in compensation math.
+ *
+ * The driver counters are only compiled in when BMP280_INSTRUMENTATION is defined for the whole project,
+ * for example with PROJECT_CPP_FLAGS += -DBMP280_INSTRUMENTATION in the Makefile. Without it the
+ * BMP280_COUNT_TRANSACTION and BMP280_MEASURE_* macros expand to nothing and the bmp280 class has no stats member.
+ *
+ * bmp280_histogram and bmp280_stopwatch don't depend on the flag. bmp280_scheduler uses them for its task
+ * statistics, so bmp280_stats.cpp is always linked. It only holds the histogram code.
+ */
+
+#ifndef BMP280_STATS_HPP
+#define BMP280_STATS_HPP
+
+#include "hwlib.hpp"
+
+/**
+ * @class bmp280_histogram
+ * @brief Minimum, maximum, mean and a log2 histogram of durations in microseconds.
+ *
+ * Bucket 0 counts durations below 1 us, bucket n counts durations from 2^(n-1) up to 2^n us,
+ * and the last bucket also counts everything longer.
+ **/
+class bmp280_histogram {
+
+public:
+    static constexpr int bucket_count = 16; /**< Number of buckets */
+
+private:
+    uint32_t count;                  /**< Number of durations */
+    uint32_t minimum;                /**< Shortest duration */
+    uint32_t maximum;                /**< Longest duration */
+    uint64_t total;                  /**< Sum of all durations */
+    uint32_t buckets[bucket_count];  /**< Number of durations per bucket */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_histogram class, the histogram starts empty.
+     */
+    bmp280_histogram();
+
+    /**
+     * @brief Remove all durations.
+     */
+    void clear();
+
+    /**
+     * @brief Add a duration.
+     * @param duration_us The duration in microseconds.
+     */
+    void add(uint32_t duration_us);
+
+    /**
+     * @brief Get the number of durations.
+     * @return The number of durations added since the last clear().
+     */
+    uint32_t getCount() const;
+
+    /**
+     * @brief Get the shortest duration.
+     * @return The shortest duration in microseconds, 0 if the histogram is empty.
+     */
+    uint32_t getMinimum() const;
+
+    /**
+     * @brief Get the longest duration.
+     * @return The longest duration in microseconds.
+     */
+    uint32_t getMaximum() const;
+
+    /**
+     * @brief Get the mean duration.
+     * @return The mean duration in microseconds, rounded down, 0 if the histogram is empty.
+     */
+    uint32_t getMean() const;
+
+    /**
+     * @brief Get the number of durations in a bucket.
+     * @param bucket The bucket, between 0 and bucket_count - 1.
+     * @return The number of durations in the bucket.
+     */
+    uint32_t getBucket(int bucket) const;
+
+    /**
+     * @brief Print the statistics and all non-empty buckets.
+     * @param name The name to print above the statistics.
+     */
+    void print(const char* name) const;
+};
+
+/**
+ * @struct bmp280_stats
+ * @brief Struct that holds the instrumentation data of a bmp280 instance.
+ */
+struct bmp280_stats {
+    uint32_t transactions = 0;       /**< Number of register bursts, reads and writes */
+    uint32_t bytes = 0;              /**< Number of register address and data bytes, without bus overhead such as i2c address bytes */
+    uint64_t bus_time_us = 0;        /**< Total time spent in bus transactions */
+    bmp280_histogram temperature;    /**< Duration of getTemperature() and getTemperatureInt(), including the bus */
+    bmp280_histogram pressure;       /**< Duration of getPressure() and getPressureInt(), including the bus */
+    bmp280_histogram compensation;   /**< Duration of the compensation math of every read method, without the bus */
+};
+
+/**
+ * @class bmp280_stopwatch
+ * @brief Adds the time between its construction and destruction to a histogram.
+ **/
+class bmp280_stopwatch {
+
+private:
+    bmp280_histogram& histogram; /**< The histogram to add the duration to */
+    uint_fast64_t start_us;      /**< Time of construction */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_stopwatch class, starts timing.
+     * @param histogram The histogram to add the duration to.
+     */
+    bmp280_stopwatch(bmp280_histogram& histogram) : histogram(histogram), start_us(hwlib::now_us()) {}
+
+    /**
+     * @brief Destructor for the bmp280_stopwatch class, adds the duration to the histogram.
+     */
+    ~bmp280_stopwatch() {
+        histogram.add(static_cast<uint32_t>(hwlib::now_us() - start_us));
+    }
+};
+
+/**
+ * @class bmp280_bus_meter
+ * @brief Adds the time between its construction and destruction to the bus time of a bmp280_stats.
+ **/
+class bmp280_bus_meter {
+
+private:
+    bmp280_stats& stats;    /**< The stats to add the duration to */
+    uint_fast64_t start_us; /**< Time of construction */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_bus_meter class, starts timing.
+     * @param stats The stats to add the duration to.
+     */
+    bmp280_bus_meter(bmp280_stats& stats) : stats(stats), start_us(hwlib::now_us()) {}
+
+    /**
+     * @brief Destructor for the bmp280_bus_meter class, adds the duration to the bus time.
+     */
+    ~bmp280_bus_meter() {
+        stats.bus_time_us += hwlib::now_us() - start_us;
+    }
+};
+
+#ifdef BMP280_INSTRUMENTATION
+/** Counts a register burst of data_size bytes */
+#define BMP280_COUNT_TRANSACTION(data_size) (stats.transactions++, stats.bytes += (data_size))
+/** Adds the time until the end of the enclosing scope to the bus time */
+#define BMP280_MEASURE_BUS() bmp280_bus_meter bmp280_bus_meter_(stats)
+/** Adds the time until the end of the enclosing scope to the named histogram of the stats */
+#define BMP280_MEASURE_TIME(histogram) bmp280_stopwatch bmp280_stopwatch_##histogram(stats.histogram)
+#else
+#define BMP280_COUNT_TRANSACTION(data_size)
+#define BMP280_MEASURE_BUS()
+#define BMP280_MEASURE_TIME(histogram)
+#endif
+
+#endif // BMP280_STATS_HPP
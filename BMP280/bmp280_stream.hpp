@@ -0,0 +1,153 @@
+/**
+ * @file bmp280_stream.hpp
+ * @brief Continuous acquisition in normal mode.
+ */
+
+#ifndef BMP280_STREAM_HPP
+#define BMP280_STREAM_HPP
+
+#include "bmp280.hpp"
+#include "bmp280_ring_buffer.hpp"
+
+/**
+ * @class bmp280_stream
+ * @brief Streams samples from a sensor in normal mode into a ring buffer.
+ *
+ * In normal mode the sensor converts continuously, with the standby time between conversions (Chapter 3.6.3
+ * of the datasheet). Unlike forced mode, no register write is needed per sample. Call service() often from the
+ * main loop. It reads each conversion exactly once and stores it in the buffer, from which consumers pull batches.
+ *
+ * The bus isn't used until the next conversion can be done. After that the data registers are read every 1/16th
+ * of a period until they change. With a short standby time the sensor is converting most of the time, so the
+ * measuring bit of the status register can't be used for this. If the data doesn't change for a full period
+ * (the maximum measurement time plus the standby time), it is taken as a new conversion with the same result.
+ *
+ * @tparam capacity The number of samples the buffer can hold.
+ **/
+template<size_t capacity>
+class bmp280_stream {
+
+private:
+    bmp280& sensor;                                       /**< The sensor to stream from */
+    bmp280_ring_buffer<bmp280_sample_int, capacity> buffer; /**< Samples that weren't read yet */
+
+    bool streaming = false;          /**< True between start() and stop() */
+    bmp280_raw_sample last = {0, 0}; /**< Raw data of the last stored conversion */
+    uint32_t period_us = 0;          /**< Maximum time between two conversions */
+    uint32_t min_period_us = 0;      /**< Minimum time between two conversions */
+    uint32_t poll_interval_us = 0;   /**< Time between two reads while waiting for new data */
+    uint_fast64_t next_poll_us = 0;  /**< Time of the next read */
+    uint_fast64_t deadline_us = 0;   /**< Time after which a new conversion is done for sure */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_stream class.
+     * @param sensor The sensor to stream from.
+     */
+    bmp280_stream(bmp280& sensor) : sensor(sensor) {}
+
+    /**
+     * @brief Configure the standby time and filter and put the sensor in normal mode.
+     * @param standby The standby time between conversions.
+     * @param filter The IIR filter coefficient.
+     */
+    void start(standby_config standby, filter_config filter) {
+        sensor.setStandby(standby);
+        sensor.setFilter(filter);
+        sensor.setPowerMode(NORMAL_MODE);
+
+        // The first conversion takes a while, until then the data registers hold an old result
+        last = sensor.readSampleRaw();
+
+        // The typical measurement time is about 85% of the maximum, see Chapter 3.8.1 of the datasheet
+        uint_fast64_t now = hwlib::now_us();
+        period_us = sensor.normalModePeriod();
+        min_period_us = period_us - sensor.measurementTime() / 4;
+        poll_interval_us = period_us / 16;
+        next_poll_us = now + sensor.measurementTime() * 3 / 4;
+        deadline_us = now + period_us;
+        streaming = true;
+    }
+
+    /**
+     * @brief Put the sensor back to sleep.
+     */
+    void stop() {
+        sensor.setPowerMode(SLEEP_MODE);
+        streaming = false;
+    }
+
+    /**
+     * @brief Read the latest conversion into the buffer if it wasn't read before.
+     * @return True if a new sample was added to the buffer.
+     */
+    bool service() {
+        if (!streaming) {
+            return false;
+        }
+
+        // The next conversion can't be done yet, so don't use the bus
+        uint_fast64_t now = hwlib::now_us();
+        if (now < next_poll_us) {
+            return false;
+        }
+
+        bmp280_raw_sample raw = sensor.readSampleRaw();
+        bool changed = raw.temperature != last.temperature || raw.pressure != last.pressure;
+        if (!changed && now < deadline_us) {
+            next_poll_us = now + poll_interval_us;
+            return false;
+        }
+
+        int32_t t_fine;
+        bmp280_sample_int sample;
+        sample.temperature = compensateTemperatureInt(sensor.getCalibrationData(), raw.temperature, t_fine);
+        sample.pressure = compensatePressureInt(sensor.getCalibrationData(), raw.pressure, t_fine);
+        buffer.push(sample);
+        last = raw;
+
+        // This conversion was done at most one poll interval ago
+        next_poll_us = now + min_period_us - poll_interval_us;
+        deadline_us = now + period_us + poll_interval_us;
+        return true;
+    }
+
+    /**
+     * @brief Get the raw data of the last conversion service() added to the buffer.
+     *
+     * Lets a consumer that needs the raw data, such as bmp280_frame_encoder, use the same detection of new
+     * conversions. Only valid after service() returned true.
+     * @return The raw temperature and pressure.
+     */
+    const bmp280_raw_sample& lastRaw() const {
+        return last;
+    }
+
+    /**
+     * @brief Get the number of samples in the buffer.
+     * @return The number of samples that weren't read yet.
+     */
+    size_t available() const {
+        return buffer.size();
+    }
+
+    /**
+     * @brief Remove up to max_count of the oldest samples from the buffer.
+     * @param samples Receives the samples, oldest first.
+     * @param max_count The maximum number of samples to read.
+     * @return The number of samples read.
+     */
+    size_t read(bmp280_sample_int* samples, size_t max_count) {
+        return buffer.pop(samples, max_count);
+    }
+
+    /**
+     * @brief Get the number of samples that were overwritten before they were read.
+     * @return The number of lost samples.
+     */
+    uint32_t lostCount() const {
+        return buffer.lostCount();
+    }
+};
+
+#endif // BMP280_STREAM_HPP
@@ -0,0 +1,93 @@
+/**
+ * @file bmp280_temperature_lut.hpp
+ * @brief Piecewise-linear lookup table for the temperature compensation.
+ */
+
+#ifndef BMP280_TEMPERATURE_LUT_HPP
+#define BMP280_TEMPERATURE_LUT_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+#include "bmp280_compensation.hpp"
+
+/**
+ * @class bmp280_temperature_lut
+ * @brief Lookup table of t_fine over the whole 20-bit raw temperature range, with linear interpolation in between.
+ *
+ * The table holds t_fine at segments + 1 evenly spaced raw values, calculated with compensateTemperature().
+ * Because segments is a power of two, finding the segment is a shift and interpolating is a single multiply-add.
+ *
+ * t_fine is a second order polynomial of the raw value (Chapter 8.1 of the datasheet), so its second derivative
+ * is the constant 2 * dig_T3 / 2^34. Linear interpolation with spacing h is off by at most h^2 / 8 times the
+ * second derivative, see maxError(). With the example calibration of the datasheet (dig_T3 = -1000) the error
+ * is 0.012 degrees Celsius for 16 segments and 0.0008 degrees Celsius for 64 segments.
+ *
+ * @tparam segments The number of segments, a power of two between 1 and 4096.
+ **/
+template<int segments>
+class bmp280_temperature_lut {
+    static_assert(segments >= 1 && segments <= 4096 && (segments & (segments - 1)) == 0,
+                  "bmp280_temperature_lut: segments must be a power of two between 1 and 4096");
+
+private:
+    static constexpr int shift() {
+        int bits = 20;
+        for (int n = segments; n > 1; n >>= 1) {
+            bits--;
+        }
+        return bits;
+    }
+
+    static constexpr int spacing_shift = shift();                 /**< log2 of the raw spacing between two table entries */
+    static constexpr uint32_t spacing_mask = (1u << spacing_shift) - 1;
+
+    float fine[segments + 1];   /**< t_fine at the start of each segment, and at the end of the last one */
+    float slope[segments];      /**< Change of t_fine per raw step within each segment */
+    float error;                /**< Maximum interpolation error in degrees Celsius */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_temperature_lut class, fills the table.
+     * @param calibration The calibration data of the sensor.
+     */
+    bmp280_temperature_lut(const bmp280_calibration_data& calibration) {
+        for (int i = 0; i <= segments; i++) {
+            int32_t t_fine;
+            uint32_t raw = static_cast<uint32_t>(i) << spacing_shift;
+            fine[i] = static_cast<float>(compensateTemperature(calibration, raw, t_fine) * 5120.0);
+        }
+        for (int i = 0; i < segments; i++) {
+            slope[i] = (fine[i + 1] - fine[i]) / static_cast<float>(1u << spacing_shift);
+        }
+
+        // h^2 / 8 * |f''| with f'' = 2 * dig_T3 / 2^34, converted from t_fine to degrees Celsius
+        double h = static_cast<double>(1u << spacing_shift);
+        double t3 = calibration.dig_T3 < 0 ? -calibration.dig_T3 : calibration.dig_T3;
+        error = static_cast<float>(h * h / 8.0 * 2.0 * t3 / 17179869184.0 / 5120.0);
+    }
+
+    /**
+     * @brief Compensate a raw temperature reading.
+     * @param raw_temp The raw 20-bit temperature reading.
+     * @param t_fine Receives the fine temperature needed to compensate the pressure of the same conversion.
+     * @return The temperature in degrees Celsius.
+     */
+    float compensate(uint32_t raw_temp, int32_t& t_fine) const {
+        uint32_t segment = (raw_temp >> spacing_shift) & (segments - 1);
+        float value = fine[segment] + slope[segment] * static_cast<float>(raw_temp & spacing_mask);
+        t_fine = static_cast<int32_t>(value);
+        return value * (1.0f / 5120.0f);
+    }
+
+    /**
+     * @brief Get the maximum difference with compensateTemperature() caused by the interpolation.
+     *
+     * Float rounding adds at most another 0.001 degrees Celsius.
+     * @return The maximum interpolation error in degrees Celsius.
+     */
+    float maxError() const {
+        return error;
+    }
+};
+
+#endif // BMP280_TEMPERATURE_LUT_HPP
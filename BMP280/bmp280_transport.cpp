@@ -0,0 +1,58 @@
+#include "bmp280_transport.hpp"
+
+bmp280_i2c_transport::bmp280_i2c_transport() :
+    bus(nullptr), i2c_address(0)
+{}
+
+bmp280_i2c_transport::bmp280_i2c_transport(hwlib::i2c_bus& bus, uint8_t i2c_address) :
+    bus(&bus), i2c_address(i2c_address)
+{}
+
+// The register address is written first, then the values are read in one transaction, Chapter 5.2.2 of the datasheet
+void bmp280_i2c_transport::readRegisters(uint8_t reg, uint8_t* data, int data_size) {
+    bus->write(i2c_address).write(reg);
+    bus->read(i2c_address).read(data, data_size);
+}
+
+// Register address and value pairs in one transaction, Chapter 5.2.1 of the datasheet
+void bmp280_i2c_transport::writeRegisters(const uint8_t* data, int data_size) {
+    bus->write(i2c_address).write(data, data_size);
+}
+
+bmp280_spi_transport::bmp280_spi_transport(hwlib::spi_bus& bus, hwlib::pin_out& chip_select) :
+    bus(bus), chip_select(chip_select)
+{}
+
+// The control byte has bit 7 set for a read, the values follow in the same transaction, Chapter 5.3.2 of the datasheet
+void bmp280_spi_transport::readRegisters(uint8_t reg, uint8_t* data, int data_size) {
+    static const uint8_t zeros[16] = {};
+    uint8_t control = reg | 0x80;
+    uint8_t ignored;
+
+    auto transaction = bus.transaction(chip_select);
+    transaction.write_and_read(1, &control, &ignored);
+    while (data_size > 0) {
+        int chunk = data_size < static_cast<int>(sizeof(zeros)) ? data_size : static_cast<int>(sizeof(zeros));
+        transaction.write_and_read(chunk, zeros, data);
+        data += chunk;
+        data_size -= chunk;
+    }
+}
+
+// Register address and value pairs with bit 7 of each address cleared, Chapter 5.3.1 of the datasheet
+void bmp280_spi_transport::writeRegisters(const uint8_t* data, int data_size) {
+    uint8_t buffer[16];
+    uint8_t ignored[16];
+
+    auto transaction = bus.transaction(chip_select);
+    while (data_size > 0) {
+        int chunk = data_size < static_cast<int>(sizeof(buffer)) ? data_size : static_cast<int>(sizeof(buffer));
+        for (int i = 0; i < chunk; i += 2) {
+            buffer[i] = data[i] & 0x7F;
+            buffer[i + 1] = data[i + 1];
+        }
+        transaction.write_and_read(chunk, buffer, ignored);
+        data += chunk;
+        data_size -= chunk;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file bmp280_transport.hpp
+ * @brief Register access of the BMP280 over I2C or SPI.
+ *
+ * The bmp280 class only reads and writes registers in bursts, through a bmp280_transport. Like the hwlib
+ * buses it is an abstract class, the virtual call is made once per burst and not once per byte.
+ */
+
+#ifndef BMP280_TRANSPORT_HPP
+#define BMP280_TRANSPORT_HPP
+
+#include "hwlib.hpp"
+
+/**
+ * @class bmp280_transport
+ * @brief Interface for burst access to the registers of a BMP280.
+ **/
+class bmp280_transport {
+
+public:
+    /**
+     * @brief Destructor for the bmp280_transport class, virtual so transports can be deleted through the interface.
+     */
+    virtual ~bmp280_transport() = default;
+
+    /**
+     * @brief Read consecutive registers in a single burst.
+     *
+     * The sensor increments the register address after every byte, for I2C and SPI alike.
+     * @param reg The address of the first register.
+     * @param data Receives the register values.
+     * @param data_size The number of registers to read.
+     */
+    virtual void readRegisters(uint8_t reg, uint8_t* data, int data_size) = 0;
+
+    /**
+     * @brief Write one or more registers in a single burst.
+     * @param data Register address and value pairs.
+     * @param data_size The number of bytes in data, twice the number of registers.
+     */
+    virtual void writeRegisters(const uint8_t* data, int data_size) = 0;
+};
+
+/**
+ * @class bmp280_i2c_transport
+ * @brief Register access over I2C, see Chapter 5.2 of the datasheet.
+ *
+ * A burst read is a write transaction with the register address followed by a read transaction,
+ * a burst write is a single write transaction with register address and value pairs.
+ **/
+class bmp280_i2c_transport : public bmp280_transport {
+
+private:
+    hwlib::i2c_bus* bus;  /**< hwlib i2c bus for communication with the sensor */
+    uint8_t i2c_address;  /**< The sensor's i2c slave address */
+
+    /**
+     * @brief Constructor for a transport without a bus, only used by bmp280 when it uses another transport.
+     */
+    bmp280_i2c_transport();
+
+    friend class bmp280;
+
+public:
+    /**
+     * @brief Constructor for the bmp280_i2c_transport class.
+     * @param bus The hwlib i2c bus the sensor is connected to.
+     * @param i2c_address The sensor's i2c slave address, 0x76 if the 'SDO' pin is connected to GND, otherwise 0x77.
+     */
+    bmp280_i2c_transport(hwlib::i2c_bus& bus, uint8_t i2c_address = 0x76);
+
+    void readRegisters(uint8_t reg, uint8_t* data, int data_size) override;
+    void writeRegisters(const uint8_t* data, int data_size) override;
+};
+
+/**
+ * @class bmp280_spi_transport
+ * @brief Register access over 4-wire SPI, see Chapter 5.3 of the datasheet.
+ *
+ * Each burst is a single transaction. Bit 7 of the register address selects a read (1) or a write (0),
+ * the sensor supports SPI clocks up to 10 MHz in mode 0 and 3.
+ **/
+class bmp280_spi_transport : public bmp280_transport {
+
+private:
+    hwlib::spi_bus& bus;         /**< hwlib spi bus for communication with the sensor */
+    hwlib::pin_out& chip_select; /**< Chip select (CSB) pin of the sensor, active low */
+
+public:
+    /**
+     * @brief Constructor for the bmp280_spi_transport class.
+     *
+     * CSB must be low at power-up or go low once before the first transaction, so the sensor selects SPI.
+     * @param bus The hwlib spi bus the sensor is connected to.
+     * @param chip_select The pin connected to CSB.
+     */
+    bmp280_spi_transport(hwlib::spi_bus& bus, hwlib::pin_out& chip_select);
+
+    void readRegisters(uint8_t reg, uint8_t* data, int data_size) override;
+    void writeRegisters(const uint8_t* data, int data_size) override;
+};
+
+#endif // BMP280_TRANSPORT_HPP
@@ -0,0 +1,197 @@
+/**
+ * @file bmp280_tuning.hpp
+ * @brief Picks the cheapest oversampling, filter and standby settings for a sample rate and noise budget.
+ *
+ * Oversampling lowers the noise, but every extra sample costs 2 ms of conversion time and the current that
+ * goes with it. The IIR filter lowers the noise for free, but makes the output follow changes more slowly.
+ * tuneConfiguration() tries every combination against the timing, noise and current data below and returns the
+ * one with the lowest average current that meets the goal. Everything is constexpr, so a configuration for a
+ * fixed goal can be computed at compile time, for example for bmp280_static:
+ *
+ * @code
+ * // 26 samples per second with at most 0.25 Pa of noise
+ * constexpr bmp280_tuning tuning = tuneConfiguration(bmp280_tuning_goal{38461, 250, 0});
+ * static_assert(tuning.feasible, "no settings meet the goal");
+ * bmp280_static<tuning.osrs_t, tuning.osrs_p, tuning.filter, tuning.standby, tuning.mode> sensor(i2c_bus);
+ * @endcode
+ */
+
+#ifndef BMP280_TUNING_HPP
+#define BMP280_TUNING_HPP
+
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+
+/**
+ * @brief Typical RMS pressure noise in mPa, by pressure oversampling (x1..x16) and filter setting (off..x16).
+ *
+ * The datasheet specifies 1.3 Pa for x1 without filter and 0.2 Pa at the highest resolution (Chapter 1 and
+ * Chapter 3.3.1). The other values follow from the sample noise dropping with the square root of the number of
+ * samples, and the variance of white noise through the IIR filter of Chapter 3.3.3 dropping by 2 * c - 1,
+ * for a filter coefficient c. Both are limited by a floor of 0.19 Pa that fits the two specified values.
+ */
+constexpr uint16_t BMP280_PRESSURE_NOISE_MPA[5][5] = {
+    {1300, 767, 522, 383, 300},
+    { 929, 559, 393, 303, 252},
+    { 671, 418, 309, 253, 223},
+    { 493, 325, 257, 224, 208},
+    { 374, 267, 227, 209, 200}
+};
+
+/**
+ * @brief Number of samples the IIR filter needs to follow 75% of a step, by filter setting (off..x16).
+ *
+ * The values are specified in Chapter 3.3.3 of the datasheet.
+ */
+constexpr uint8_t BMP280_FILTER_RESPONSE_SAMPLES[5] = {1, 2, 5, 11, 22};
+
+/**
+ * @brief Typical supply current while measuring temperature, in uA.
+ */
+constexpr uint32_t BMP280_TEMPERATURE_CURRENT_UA = 325;
+
+/**
+ * @brief Typical supply current while measuring pressure, in uA.
+ */
+constexpr uint32_t BMP280_PRESSURE_CURRENT_UA = 720;
+
+/**
+ * @brief Typical supply current in sleep mode, in nA.
+ */
+constexpr uint32_t BMP280_SLEEP_CURRENT_NA = 100;
+
+/**
+ * @brief Typical supply current during the standby time in normal mode, in nA.
+ */
+constexpr uint32_t BMP280_STANDBY_CURRENT_NA = 200;
+
+/**
+ * @brief Get the typical charge drawn by a single conversion.
+ *
+ * Uses the typical currents from Chapter 1 of the datasheet and the typical measurement time of Chapter 3.8.1:
+ * the temperature part (1 ms + 2 ms per sample) at the temperature current, and the pressure part
+ * (2 ms per sample + 0.5 ms) at the pressure current.
+ * @param osrs_t The oversampling setting for temperature.
+ * @param osrs_p The oversampling setting for pressure.
+ * @return The charge in nC.
+ */
+constexpr uint32_t conversionChargeNc(sampling_config osrs_t, sampling_config osrs_p) {
+    return (1000 + 2000 * oversamplingFactor(osrs_t)) * BMP280_TEMPERATURE_CURRENT_UA / 1000
+         + (osrs_p == SAMPLING_NONE ? 0 : (2000 * oversamplingFactor(osrs_p) + 500) * BMP280_PRESSURE_CURRENT_UA / 1000);
+}
+
+/**
+ * @brief Get the temperature oversampling to use with a pressure oversampling.
+ *
+ * More temperature samples don't lower the pressure noise much, so Chapter 3.4 of the datasheet uses
+ * x2 with x16 pressure oversampling and x1 otherwise.
+ * @param osrs_p The oversampling setting for pressure.
+ * @return The oversampling setting for temperature.
+ */
+constexpr sampling_config temperatureOversamplingFor(sampling_config osrs_p) {
+    return osrs_p == SAMPLING_X16 ? SAMPLING_X2 : SAMPLING_X1;
+}
+
+/**
+ * @struct bmp280_tuning_goal
+ * @brief Struct that holds the requirements for tuneConfiguration().
+ */
+typedef struct {
+    uint32_t period_us;         /**< Maximum time between two samples, 1000000 divided by the sample rate in Hz */
+    uint16_t noise_mpa;         /**< Maximum RMS pressure noise in mPa */
+    uint32_t max_response_us;   /**< Maximum time to follow 75% of a step, 0 if it doesn't matter */
+} bmp280_tuning_goal;
+
+/**
+ * @struct bmp280_tuning
+ * @brief Struct that holds the settings picked by tuneConfiguration() and what they are expected to cost.
+ *
+ * In normal mode the sensor converts with the standby time in between. In forced mode the application
+ * starts a conversion every period_us, for example with startMeasurement().
+ */
+typedef struct {
+    bool feasible;                  /**< False if no settings meet the goal, the other fields are then invalid */
+    power_modes mode;               /**< NORMAL_MODE or FORCED_MODE */
+    sampling_config osrs_t;         /**< Temperature oversampling */
+    sampling_config osrs_p;         /**< Pressure oversampling */
+    filter_config filter;           /**< IIR filter coefficient */
+    standby_config standby;         /**< Standby time, only used in normal mode */
+    uint32_t period_us;             /**< Time between two samples */
+    uint32_t measurement_time_us;   /**< Maximum conversion time */
+    uint32_t typical_time_us;       /**< Typical conversion time */
+    uint32_t current_na;            /**< Typical average supply current in nA */
+    uint16_t noise_mpa;             /**< Typical RMS pressure noise in mPa */
+    uint32_t response_us;           /**< Time to follow 75% of a step */
+} bmp280_tuning;
+
+/**
+ * @brief Find the settings with the lowest average current that meet a goal.
+ *
+ * Normal mode is used when a standby time gives a sample rate at most 10% above the required rate, so no bus
+ * traffic is needed to start conversions. Otherwise forced mode at exactly the required period uses less current.
+ * The goal is a period rather than a rate, so slow rates such as one sample per minute are exact.
+ * Of the filter settings that meet the noise budget, the one that follows changes the fastest is used.
+ * The timing, noise and current are those of a BMP280. On a BME280 STANDBY_MS_2000 and STANDBY_MS_4000 mean
+ * 10 ms and 20 ms, so check the period with normalModePeriod() after configure().
+ * @param goal The requirements.
+ * @return The settings, check feasible before using them.
+ */
+constexpr bmp280_tuning tuneConfiguration(const bmp280_tuning_goal& goal) {
+    bmp280_tuning best = {false, SLEEP_MODE, SAMPLING_NONE, SAMPLING_NONE, FILTER_OFF, STANDBY_MS_1, 0, 0, 0, 0, 0, 0};
+    if (goal.period_us == 0) {
+        return best;
+    }
+    uint32_t target_us = goal.period_us;
+
+    for (int p = SAMPLING_X1; p <= SAMPLING_X16; p++) {
+        sampling_config osrs_p = static_cast<sampling_config>(p);
+        sampling_config osrs_t = temperatureOversamplingFor(osrs_p);
+        uint32_t measurement_us = measurementTimeUs(osrs_t, osrs_p);
+        if (measurement_us > target_us) {
+            continue;
+        }
+
+        // The longest standby time that still meets the sample rate
+        bmp280_tuning candidate = {true, FORCED_MODE, osrs_t, osrs_p, FILTER_OFF, STANDBY_MS_1, target_us, measurement_us,
+                                   typicalMeasurementTimeUs(osrs_t, osrs_p), 0, 0, 0};
+        for (int s = STANDBY_MS_4000; s >= STANDBY_MS_1; s--) {
+            uint32_t period_us = measurement_us + standbyTimeUs(static_cast<standby_config>(s));
+            if (period_us <= target_us) {
+                if (period_us >= target_us - target_us / 11) {
+                    candidate.mode = NORMAL_MODE;
+                    candidate.standby = static_cast<standby_config>(s);
+                    candidate.period_us = period_us;
+                }
+                break;
+            }
+        }
+
+        // The filter costs no current, so take the weakest one that meets the noise budget
+        bool found = false;
+        for (int f = FILTER_OFF; f <= FILTER_X16 && !found; f++) {
+            uint16_t noise_mpa = BMP280_PRESSURE_NOISE_MPA[p - SAMPLING_X1][f];
+            // Saturate, 22 samples of a long period don't fit in 32 bits
+            uint64_t response = static_cast<uint64_t>(BMP280_FILTER_RESPONSE_SAMPLES[f]) * candidate.period_us;
+            uint32_t response_us = response > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(response);
+            if (noise_mpa <= goal.noise_mpa && (goal.max_response_us == 0 || response_us <= goal.max_response_us)) {
+                candidate.filter = static_cast<filter_config>(f);
+                candidate.noise_mpa = noise_mpa;
+                candidate.response_us = response_us;
+                found = true;
+            }
+        }
+        if (!found) {
+            continue;
+        }
+
+        uint32_t idle_na = candidate.mode == NORMAL_MODE ? BMP280_STANDBY_CURRENT_NA : BMP280_SLEEP_CURRENT_NA;
+        candidate.current_na = static_cast<uint32_t>(static_cast<uint64_t>(conversionChargeNc(osrs_t, osrs_p)) * 1000000
+                                                     / candidate.period_us) + idle_na;
+        if (!best.feasible || candidate.current_na < best.current_na) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+#endif // BMP280_TUNING_HPP
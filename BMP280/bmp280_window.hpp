@@ -0,0 +1,360 @@
+/**
+ * @file bmp280_window.hpp
+ * @brief Minimum, maximum, mean, variance and trend over a sliding time window, updated with every sample.
+ *
+ * A weather station wants to know the lowest temperature of the last day or how much the pressure fell in the
+ * last three hours. Keeping every sample and going over them for every question takes a lot of memory and time.
+ * A bmp280_rolling_window divides the window into buckets of equal duration and only keeps a few sums per bucket,
+ * so adding a sample and every query take constant time, and the memory is fixed at compile time:
+ *
+ * @code
+ * // The last 3 hours in buckets of 5 minutes
+ * bmp280_rolling_window<36> pressure(300000000);
+ *
+ * pressure.add(sample.pressure, hwlib::now_us());
+ * int32_t lowest = pressure.getMinimum();
+ * int32_t tendency = pressure.getTrend(36); // The change over 3 hours of the best fitting line
+ * @endcode
+ */
+
+#ifndef BMP280_WINDOW_HPP
+#define BMP280_WINDOW_HPP
+
+#include <stdint.h>
+#include "bmp280_filter.hpp"
+
+/**
+ * @class bmp280_monotonic_deque
+ * @brief The minimum or maximum of the values of a sliding window of buckets.
+ *
+ * Only values that can still become the extreme are kept: a new value removes every older value that isn't more
+ * extreme, because the older value leaves the window first. The kept values are therefore sorted, the extreme is
+ * at the front, and every value is added and removed once.
+ * @tparam capacity The number of buckets in the window.
+ * @tparam maximum True to track the maximum, false to track the minimum.
+ **/
+template<int capacity, bool maximum>
+class bmp280_monotonic_deque {
+
+private:
+    /**
+     * @struct entry
+     * @brief A kept value and the bucket it was added in.
+     */
+    struct entry {
+        uint32_t bucket; /**< Sequence number of the bucket, wrapping around */
+        int32_t value;   /**< The value */
+    };
+
+    entry entries[capacity]; /**< The kept values, used as a ring, at most one per bucket */
+    int head = 0;            /**< Index of the front */
+    int count = 0;           /**< Number of kept values */
+
+    // True if the kept value stays the extreme when the added value is in the window too
+    static bool keeps(int32_t kept, int32_t added) {
+        return maximum ? kept > added : kept < added;
+    }
+
+public:
+    /**
+     * @brief Add a value to the newest bucket.
+     * @param bucket The sequence number of the newest bucket, never lower than that of earlier calls.
+     * @param value The value.
+     */
+    void push(uint32_t bucket, int32_t value) {
+        if (count > 0) {
+            // A value of the same bucket leaves the window at the same time, so only the most extreme is needed
+            const entry& back = entries[(head + count - 1) % capacity];
+            if (back.bucket == bucket && keeps(back.value, value)) {
+                return;
+            }
+        }
+        while (count > 0 && !keeps(entries[(head + count - 1) % capacity].value, value)) {
+            count--;
+        }
+        entries[(head + count) % capacity] = entry{bucket, value};
+        count++;
+    }
+
+    /**
+     * @brief Remove the values of the buckets that left the window.
+     * @param oldest The sequence number of the oldest bucket that is still in the window.
+     */
+    void evict(uint32_t oldest) {
+        while (count > 0 && static_cast<int32_t>(entries[head].bucket - oldest) < 0) {
+            head = (head + 1) % capacity;
+            count--;
+        }
+    }
+
+    /**
+     * @brief Get the extreme of the window.
+     * @return The minimum or maximum, 0 if the window is empty.
+     */
+    int32_t front() const {
+        return count > 0 ? entries[head].value : 0;
+    }
+
+    /**
+     * @brief Remove all values.
+     */
+    void reset() {
+        head = 0;
+        count = 0;
+    }
+};
+
+/**
+ * @class bmp280_rolling_window
+ * @brief Statistics of the samples of the last bucket_count buckets, each bucket_us long.
+ *
+ * The window moves a whole bucket at a time: it holds the current bucket and the bucket_count - 1 before it. Per
+ * bucket only the number of samples, their sum and their sum of squares are kept, so a bucket that leaves the
+ * window is subtracted from the running sums. The minimum and maximum are kept by a bmp280_monotonic_deque each.
+ *
+ * The trend is the least-squares line through all samples, with the bucket of a sample as its time. Samples that
+ * are spread the same way within every bucket give the same slope as their exact times would, and the sums stay
+ * small enough for exact integer math. When the window moves, the positions of all buckets shift by one, which
+ * is also applied to the sums at once instead of per bucket.
+ *
+ * The sums are 64 bits wide and hold the distance of every sample to the first sample of the window. They are large
+ * enough for 65536 samples per window within 2^23 of the first sample, such as the pressure in Q24.8 Pa within
+ * 320 hPa, and for more samples of a smaller range, such as the temperature in 0.01 degrees Celsius.
+ * @tparam bucket_count The number of buckets in the window.
+ **/
+template<int bucket_count>
+class bmp280_rolling_window {
+
+    static_assert(bucket_count >= 2 && bucket_count <= 1024, "a rolling window must have between 2 and 1024 buckets");
+
+private:
+    /**
+     * @struct bucket
+     * @brief The sums of the samples of one bucket.
+     */
+    struct bucket {
+        uint32_t count;   /**< Number of samples */
+        int64_t sum;      /**< Sum of the distances to the reference */
+        int64_t squares;  /**< Sum of the squared distances to the reference */
+    };
+
+    uint32_t bucket_us;               /**< Duration of a bucket */
+    bucket buckets[bucket_count];     /**< The sums per bucket, bucket n is stored at index n % bucket_count */
+    uint_fast64_t newest = 0;         /**< Sequence number of the current bucket, the time divided by bucket_us */
+    bool started = false;             /**< False until the first call of add() or advance() */
+    int32_t reference = 0;            /**< The first sample of the window, the values are summed relative to it */
+
+    uint32_t count = 0;               /**< Number of samples in the window */
+    int64_t sum = 0;                  /**< Sum of the distances to the reference */
+    int64_t squares = 0;              /**< Sum of the squared distances to the reference */
+    int64_t position_sum = 0;         /**< Sum of the positions, the oldest bucket of the window is position 0 */
+    int64_t position_squares = 0;     /**< Sum of the squared positions */
+    int64_t products = 0;             /**< Sum of the positions times the distances to the reference */
+
+    bmp280_monotonic_deque<bucket_count, false> minimum; /**< The minimum of the window */
+    bmp280_monotonic_deque<bucket_count, true> maximum;  /**< The maximum of the window */
+
+    // Removes the oldest bucket and moves the other buckets one position back
+    void shift() {
+        newest++;
+        bucket& oldest = buckets[newest % bucket_count];
+        count -= oldest.count;
+        sum -= oldest.sum;
+        squares -= oldest.squares;
+        oldest = bucket{0, 0, 0};
+
+        // The removed bucket was at position 0, so it added nothing to the position sums
+        position_squares -= 2 * position_sum - count;
+        position_sum -= count;
+        products -= sum;
+    }
+
+public:
+    /**
+     * @brief Constructor for the bmp280_rolling_window class, the window starts empty.
+     * @param bucket_us The duration of a bucket, the window is bucket_count times as long.
+     */
+    bmp280_rolling_window(uint32_t bucket_us):
+        bucket_us(bucket_us)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Remove all samples.
+     */
+    void clear() {
+        for (int i = 0; i < bucket_count; i++) {
+            buckets[i] = bucket{0, 0, 0};
+        }
+        started = false;
+        count = 0;
+        sum = 0;
+        squares = 0;
+        position_sum = 0;
+        position_squares = 0;
+        products = 0;
+        minimum.reset();
+        maximum.reset();
+    }
+
+    /**
+     * @brief Move the window to a time, so the samples that are too old are no longer included.
+     *
+     * add() does this too, call it before a query when no sample was added for a while. Every bucket is moved past
+     * once, so the cost per bucket_us is constant.
+     * @param now_us The current time, for example from hwlib::now_us(). A time before the current bucket is ignored.
+     */
+    void advance(uint_fast64_t now_us) {
+        uint_fast64_t target = now_us / bucket_us;
+        if (!started) {
+            newest = target;
+            started = true;
+            return;
+        }
+        if (target <= newest) {
+            return;
+        }
+        if (target - newest >= static_cast<uint_fast64_t>(bucket_count)) {
+            clear();
+            newest = target;
+            started = true;
+            return;
+        }
+        while (newest < target) {
+            shift();
+        }
+        uint32_t oldest = static_cast<uint32_t>(newest - (bucket_count - 1));
+        minimum.evict(oldest);
+        maximum.evict(oldest);
+    }
+
+    /**
+     * @brief Add a sample.
+     * @param value The sample, for example the temperature or pressure of a bmp280_sample_int.
+     * @param now_us The time of the sample. A sample from before the current bucket is added to the current bucket.
+     */
+    void add(int32_t value, uint_fast64_t now_us) {
+        advance(now_us);
+        if (count == 0) {
+            reference = value;
+        }
+
+        int64_t distance = static_cast<int64_t>(value) - reference;
+        int64_t position = bucket_count - 1;
+        bucket& current = buckets[newest % bucket_count];
+        current.count++;
+        current.sum += distance;
+        current.squares += distance * distance;
+
+        count++;
+        sum += distance;
+        squares += distance * distance;
+        position_sum += position;
+        position_squares += position * position;
+        products += position * distance;
+
+        minimum.push(static_cast<uint32_t>(newest), value);
+        maximum.push(static_cast<uint32_t>(newest), value);
+    }
+
+    /**
+     * @brief Get the number of samples in the window.
+     * @return The number of samples.
+     */
+    uint32_t getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Get the duration of a bucket.
+     * @return The duration of a bucket in microseconds.
+     */
+    uint32_t getBucketTime() const {
+        return bucket_us;
+    }
+
+    /**
+     * @brief Get the lowest sample in the window.
+     * @return The lowest sample, 0 if the window is empty.
+     */
+    int32_t getMinimum() const {
+        return minimum.front();
+    }
+
+    /**
+     * @brief Get the highest sample in the window.
+     * @return The highest sample, 0 if the window is empty.
+     */
+    int32_t getMaximum() const {
+        return maximum.front();
+    }
+
+    /**
+     * @brief Get the mean of the samples in the window.
+     *
+     * Halfway cases are rounded up rather than away from zero, so the result doesn't depend on the reference.
+     * @return The mean, rounded to the nearest integer, 0 if the window is empty.
+     */
+    int32_t getMean() const {
+        if (count == 0) {
+            return 0;
+        }
+        int64_t numerator = 2 * sum + count;
+        int64_t divisor = 2 * static_cast<int64_t>(count);
+        int64_t rounded = numerator / divisor;
+        if (numerator % divisor != 0 && numerator < 0) {
+            rounded--;
+        }
+        return reference + static_cast<int32_t>(rounded);
+    }
+
+    /**
+     * @brief Get the variance of the samples in the window, the square of the standard deviation.
+     *
+     * With sum = q * count + r, count^2 * variance = count * squares - sum^2 = count * (squares - q * (q * count + 2 * r)) - r^2,
+     * which stays within 64 bits.
+     * @return The population variance in the unit of the samples squared, rounded down, 0 if the window is empty.
+     */
+    uint64_t getVariance() const {
+        if (count == 0) {
+            return 0;
+        }
+        int64_t n = count;
+        int64_t q = sum / n;
+        int64_t r = sum - q * n;
+        int64_t scaled = squares - q * (q * n + 2 * r);
+        return static_cast<uint64_t>((scaled - (r * r + n - 1) / n) / n);
+    }
+
+    /**
+     * @brief Get the change of the least-squares line through the samples over a number of buckets.
+     *
+     * With the positions x and the distances d, the slope per bucket is
+     * (count * sum(x * d) - sum(x) * sum(d)) / (count * sum(x^2) - sum(x)^2). Both are calculated without overflow
+     * the same way as the variance.
+     * @param span The number of buckets, bucket_count for the change over the whole window.
+     * @return The change in the unit of the samples, rounded to the nearest integer, 0 if the samples are in
+     * fewer than two buckets.
+     */
+    int32_t getTrend(uint32_t span) const {
+        if (count < 2) {
+            return 0;
+        }
+        int64_t n = count;
+        int64_t spread = n * position_squares - position_sum * position_sum;
+        if (spread == 0) {
+            return 0;
+        }
+        int64_t q = sum / n;
+        int64_t r = sum - q * n;
+        int64_t covariance = n * (products - position_sum * q) - position_sum * r;
+
+        // Split off the whole part first, so covariance * span can't overflow
+        int64_t whole = covariance / spread;
+        int64_t remainder = covariance - whole * spread;
+        return static_cast<int32_t>(whole * span + bmp280RoundedDivide(remainder * span, spread));
+    }
+};
+
+#endif // BMP280_WINDOW_HPP
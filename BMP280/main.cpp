@@ -1,20 +1,199 @@
 #include "hwlib.hpp"
 #include "bmp280.hpp"
+#include "oled_frontend.hpp"
+#include "bmp280_reporter.hpp"
+#include "bmp280_protocol.hpp"
+#include "bmp280_stream.hpp"
+#include "bmp280_scheduler.hpp"
+#include "bmp280_window.hpp"
 
-const char* getOutfitRecommendation(float temperature) {
+// The temperature is in 0.01 degrees Celsius, so no floating point math is needed on the Due
+const char* getOutfitRecommendation(int32_t temperature) {
     if (temperature < 0) {
         return "It's freezing outside! Wear a heavy coat, gloves, and a hat.";
-    } else if (temperature < 10) {
+    } else if (temperature < 1000) {
         return "It's pretty cold. Wear a coat and a hat.";
-    } else if (temperature < 20) {
+    } else if (temperature < 2000) {
         return "It's a bit chilly. A jacket should suffice.";
-    } else if (temperature < 30) {
+    } else if (temperature < 3000) {
         return "It's warm. A t-shirt and shorts would be comfortable.";
     } else {
         return "It's very hot. Wear light clothing and stay hydrated.";
     }
 }
 
+// The change of the pressure over 3 hours in Pa, with the thresholds of the barometric tendency:
+// up to 1.5 hPa is a slow change, from 3.6 hPa a quick one
+const char* getPressureForecast(int32_t tendency) {
+    if (tendency <= -360) {
+        return "The pressure is falling quickly, expect wind and rain.";
+    } else if (tendency <= -160) {
+        return "The pressure is falling, the weather may get worse.";
+    } else if (tendency < 160) {
+        return "The pressure is steady.";
+    } else if (tendency < 360) {
+        return "The pressure is rising, the weather may get better.";
+    } else {
+        return "The pressure is rising quickly, expect clearing skies and some wind.";
+    }
+}
+
+#ifdef BMP280_BINARY_STREAM
+void writeFrame(const uint8_t* frame, int size) {
+    for (int i = 0; i < size; i++) {
+        hwlib::cout << static_cast<char>(frame[i]);
+    }
+}
+
+// Sends every conversion as a 5 byte record in binary frames, decode them on the PC with BMP280_decoder
+void streamBinary(bmp280& sensor) {
+    // Continuous conversions with the shortest standby time, about 150 samples per second. The stream detects
+    // every new conversion, so each one is sent once and the sequence numbers count conversions, not reads.
+    bmp280_stream<1> stream(sensor);
+    stream.start(STANDBY_MS_1, FILTER_OFF);
+    uint32_t period_us = sensor.normalModePeriod();
+
+    bmp280_frame_encoder encoder;
+    bmp280_sample_int sample;
+    uint32_t frames = 0;
+    while (true) {
+        // Repeat the calibration now and then, so the decoder can be started at any time
+        if (frames % 256 == 0) {
+            int size = encoder.encodeCalibration(sensor.getCalibrationData(), period_us);
+            writeFrame(encoder.getFrame(), size);
+        }
+
+        // A sample frame is done every 8 samples, the calibration is only sent between two sample frames
+        int size = 0;
+        while (size == 0) {
+            if (stream.service()) {
+                // Only the raw data is sent, the compensated sample isn't needed
+                stream.read(&sample, 1);
+                size = encoder.add(stream.lastRaw());
+            }
+        }
+        writeFrame(encoder.getFrame(), size);
+        frames++;
+    }
+}
+#endif
+
+// The last reported sample, shared by the sampling task and the tasks that show it
+struct report {
+    bmp280_sample_int sample;   // The sample
+    bool print_pending;         // Not printed yet
+    bool draw_pending;          // Not drawn yet
+};
+
+// Every sample of the last day, kept as sums per bucket so no history has to be stored or scanned
+struct weather_history {
+    bmp280_rolling_window<24> temperature;  // The last 24 hours in buckets of 1 hour
+    bmp280_rolling_window<36> pressure;     // The last 3 hours in buckets of 5 minutes
+};
+
+// Takes a sample, adds it to the history and hands it to the other tasks when the temperature changed enough
+class sampling_task : public bmp280_task {
+private:
+    bmp280& sensor;
+    bmp280_reporter& reporter;
+    report& latest;
+    weather_history& history;
+
+public:
+    sampling_task(bmp280& sensor, bmp280_reporter& reporter, report& latest, weather_history& history):
+        sensor(sensor), reporter(reporter), latest(latest), history(history)
+    {}
+
+    void run(uint_fast64_t release_us) override {
+        // Start a new conversion and sleep until it should be done, the sensor returns to sleep mode afterwards
+        sensor.startMeasurement();
+        hwlib::wait_us(sensor.remainingMeasurementTime());
+        while (!sensor.poll()) {}
+
+        // The release time is the timestamp, so the samples are exactly one period apart
+        bmp280_sample_int sample = sensor.collectInt();
+        history.temperature.add(sample.temperature, release_us);
+        history.pressure.add(static_cast<int32_t>(sample.pressure), release_us);
+        if (reporter.update(sample, release_us) & REPORT_TEMPERATURE) {
+            latest.sample = sample;
+            latest.print_pending = true;
+            latest.draw_pending = true;
+        }
+    }
+};
+
+// Prints the compensated data, the outfit recommendation and the pressure forecast
+class printing_task : public bmp280_task {
+private:
+    report& latest;
+    weather_history& history;
+
+public:
+    printing_task(report& latest, weather_history& history):
+        latest(latest), history(history)
+    {}
+
+    void run(uint_fast64_t) override {
+        if (!latest.print_pending) {
+            return;
+        }
+        latest.print_pending = false;
+
+        int32_t temperature = latest.sample.temperature;
+        hwlib::cout << "Temperature: " << temperature / 100 << "C\n";
+        hwlib::cout << getOutfitRecommendation(temperature) << "\n";
+
+        // The pressure is in Q24.8 Pa, the trend is the change of the best fitting line over the last 3 hours
+        int32_t tendency = history.pressure.getTrend(36) / 256;
+        hwlib::cout << "Pressure: " << history.pressure.getMean() / 25600 << " hPa, " << tendency << " Pa in 3 hours\n";
+        hwlib::cout << getPressureForecast(tendency) << "\n";
+        hwlib::cout << "Last 24 hours: " << history.temperature.getMinimum() / 100 << " to "
+                    << history.temperature.getMaximum() / 100 << "C\n";
+        hwlib::cout << hwlib::endl;
+    }
+};
+
+// Draws the outfit recommendation and the temperature on the OLED
+class drawing_task : public bmp280_task {
+private:
+    text_frontend& display;
+    report& latest;
+
+public:
+    drawing_task(text_frontend& display, report& latest):
+        display(display), latest(latest)
+    {}
+
+    void run(uint_fast64_t) override {
+        if (!latest.draw_pending) {
+            return;
+        }
+        latest.draw_pending = false;
+
+        int32_t temperature = latest.sample.temperature;
+        display.clear();
+        display.printWrapped(0, getOutfitRecommendation(temperature));
+        int column = display.print(3, 5, temperature / 100);
+        display.print(column, 5, " C");
+        display.flush();
+    }
+};
+
+// Prints how well the tasks keep their deadlines
+class statistics_task : public bmp280_task {
+private:
+    bmp280_scheduler<4>& scheduler;
+
+public:
+    statistics_task(bmp280_scheduler<4>& scheduler):
+        scheduler(scheduler)
+    {}
+
+    void run(uint_fast64_t) override {
+        scheduler.printStats();
+    }
+};
+
 int main() {
     namespace target = hwlib::target;  // Adjust to your target board
 
@@ -31,38 +210,44 @@ int main() {
     // Create the BMP280 and OLED objects
     bmp280 sensor(i2c_bus_bmp);
     
-    auto oled = hwlib::glcd_oled( i2c_bus_oled );
+    // The window only sends changed bytes and the front-end only redraws changed characters
+    auto oled = oled_buffered_window( i2c_bus_oled );
     auto font = hwlib::font_default_8x8();
-    auto display = hwlib::terminal_from(oled,font);
+    auto terminal = hwlib::terminal_from(oled,font);
+    auto display = text_frontend(terminal, oled);
     
     sensor.setup();
     
     hwlib::wait_ms(10);
 
+#ifdef BMP280_BINARY_STREAM
+    streamBinary(sensor);
+#endif
+
     // Print debug information to check if the sensor is properly set up
     sensor.printDebug();
 
-    // Infinite loop to continuously read from the sensor
-    while (true) {
+    // Only report a temperature change of at least 0.5 C, 0.75 C after a change of direction,
+    // and at least once a minute. The pressure isn't shown, so its settings don't matter.
+    bmp280_reporter reporter(
+        bmp280_deadband{50, 0, 25, 60000},
+        bmp280_deadband{0, 0, 0, 0});
 
-        // Print the compensated data
-        float temperature = sensor.getTemperature();
-        hwlib::cout << "Temperature: " << (int)temperature << "C\n";
-    
-        // Print the outfit recommendation
-        const char* recommendation = getOutfitRecommendation(temperature);
-        hwlib::cout << recommendation << "\n";
-        hwlib::cout << hwlib::endl;
-
-        display
-            << "\f" << recommendation  
-            << "\t0305" << (int) temperature << " C"
-            << "\n" 
-            << hwlib::flush;   
-        
-        // Delay for a second
-        hwlib::wait_ms(20000);
-    }
+    // Sampling has the highest priority, so its timestamps stay on the grid of its period. Redundant samples
+    // cost no serial or OLED traffic, so the sensor can be sampled often.
+    report latest = {{0, 0}, false, false};
+    weather_history history = {bmp280_rolling_window<24>(3600000000u), bmp280_rolling_window<36>(300000000)};
+    bmp280_scheduler<4> scheduler;
+    sampling_task sampling(sensor, reporter, latest, history);
+    drawing_task drawing(display, latest);
+    printing_task printing(latest, history);
+    statistics_task statistics(scheduler);
+    scheduler.add(sampling, "sampling", 1000000, PRIORITY_ACQUISITION);
+    scheduler.add(drawing, "display", 250000, PRIORITY_DISPLAY, 100000);
+    scheduler.add(printing, "printing", 250000, PRIORITY_LOGGING, 150000);
+    scheduler.add(statistics, "statistics", 600000000, PRIORITY_LOGGING, 600000000);
+    scheduler.start();
+    scheduler.run();
 
     return 0;
 }
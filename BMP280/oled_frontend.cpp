@@ -0,0 +1,211 @@
+#include "oled_frontend.hpp"
+
+oled_buffered_window::oled_buffered_window(hwlib::i2c_bus& bus, uint8_t i2c_address) :
+    hwlib::window(hwlib::xy(width, height), hwlib::white, hwlib::black),
+    bus(bus), i2c_address(i2c_address), synced(false), byte_count(0)
+{
+    for (int i = 0; i < pages * width; i++) {
+        buffer[i] = 0;
+        shown[i] = 0;
+    }
+    for (int page = 0; page < pages; page++) {
+        dirty_first[page] = 0;
+        dirty_last[page] = width - 1;
+    }
+    initialize();
+}
+
+// The same settings as hwlib::glcd_oled, but with horizontal addressing so a range of columns can be sent at once
+void oled_buffered_window::initialize() {
+    static const uint8_t commands[] = {
+        0x00,              // control byte: a stream of commands follows
+        0xAE,              // display off
+        0xD5, 0x80,        // clock divide ratio
+        0xA8, 0x3F,        // multiplex ratio, 64 rows
+        0xD3, 0x00,        // display offset
+        0x40,              // start line 0
+        0x8D, 0x14,        // charge pump on
+        0x20, 0x00,        // horizontal addressing mode
+        0xA1,              // segment remap
+        0xC8,              // scan from the last row to the first
+        0xDA, 0x12,        // com pins
+        0x81, 0xCF,        // contrast
+        0xD9, 0xF1,        // precharge period
+        0xDB, 0x40,        // vcomh deselect level
+        0xA4,              // show the memory contents
+        0xA6,              // not inverted
+        0xAF               // display on
+    };
+    bus.write(i2c_address).write(commands, sizeof(commands));
+    byte_count += sizeof(commands) + 1;
+}
+
+void oled_buffered_window::write_implementation(hwlib::xy pos, hwlib::color col) {
+    int index = pos.x + (pos.y / 8) * width;
+    uint8_t mask = static_cast<uint8_t>(1 << (pos.y % 8));
+    if (col == foreground) {
+        buffer[index] |= mask;
+    } else {
+        buffer[index] &= static_cast<uint8_t>(~mask);
+    }
+
+    int page = pos.y / 8;
+    if (pos.x < dirty_first[page]) {
+        dirty_first[page] = pos.x;
+    }
+    if (pos.x > dirty_last[page]) {
+        dirty_last[page] = pos.x;
+    }
+}
+
+void oled_buffered_window::clear_implementation(hwlib::color col) {
+    uint8_t value = col == foreground ? 0xFF : 0x00;
+    for (int i = 0; i < pages * width; i++) {
+        buffer[i] = value;
+    }
+    for (int page = 0; page < pages; page++) {
+        dirty_first[page] = 0;
+        dirty_last[page] = width - 1;
+    }
+}
+
+void oled_buffered_window::flush() {
+    for (int page = 0; page < pages; page++) {
+        int first = dirty_first[page];
+        int last = dirty_last[page];
+        dirty_first[page] = width;
+        dirty_last[page] = -1;
+
+        // Only send the columns that differ from what the display shows, a clear followed by a redraw of the
+        // same content sends nothing
+        const uint8_t* row = buffer + page * width;
+        uint8_t* shown_row = shown + page * width;
+        if (synced) {
+            while (first <= last && row[first] == shown_row[first]) {
+                first++;
+            }
+            while (last >= first && row[last] == shown_row[last]) {
+                last--;
+            }
+        }
+        if (first > last) {
+            continue;
+        }
+
+        const uint8_t commands[] = {
+            0x00,                                                        // control byte: commands
+            0x21, static_cast<uint8_t>(first), static_cast<uint8_t>(last), // column range
+            0x22, static_cast<uint8_t>(page), static_cast<uint8_t>(page)   // page range
+        };
+        bus.write(i2c_address).write(commands, sizeof(commands));
+
+        {
+            auto transaction = bus.write(i2c_address);
+            transaction.write(0x40);                                     // control byte: data
+            transaction.write(row + first, last - first + 1);
+        }
+        byte_count += sizeof(commands) + 1 + (last - first + 1) + 2;
+
+        for (int column = first; column <= last; column++) {
+            shown_row[column] = row[column];
+        }
+    }
+    synced = true;
+}
+
+uint32_t oled_buffered_window::bytesSent() const {
+    return byte_count;
+}
+
+text_frontend::text_frontend(hwlib::ostream& terminal, hwlib::window& window) :
+    terminal(terminal), window(window), synced(false)
+{
+    clear();
+}
+
+void text_frontend::clear() {
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            pending[row][column] = ' ';
+        }
+    }
+}
+
+int text_frontend::print(int column, int row, const char* text) {
+    for (; *text != '\0'; text++, column++) {
+        if (row >= 0 && row < rows && column >= 0 && column < columns) {
+            pending[row][column] = *text;
+        }
+    }
+    return column;
+}
+
+int text_frontend::print(int column, int row, int32_t value) {
+    char digits[12];
+    int length = 0;
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    do {
+        digits[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[length++] = '-';
+    }
+
+    char text[12];
+    for (int i = 0; i < length; i++) {
+        text[i] = digits[length - 1 - i];
+    }
+    text[length] = '\0';
+    return print(column, row, text);
+}
+
+int text_frontend::printWrapped(int row, const char* text) {
+    while (*text != '\0' && row < rows) {
+        // Skip the spaces at the start of a line
+        while (*text == ' ') {
+            text++;
+        }
+
+        // Find the end of the last word that fits on this line
+        int end = 0;
+        int last_space = -1;
+        while (text[end] != '\0' && end < columns) {
+            if (text[end] == ' ') {
+                last_space = end;
+            }
+            end++;
+        }
+
+        int fits = end;
+        if (text[end] != '\0' && text[end] != ' ' && last_space > 0) {
+            fits = last_space;
+        }
+
+        for (int column = 0; column < fits; column++) {
+            pending[row][column] = text[column];
+        }
+        text += fits;
+        row++;
+    }
+    return row;
+}
+
+// hwlib terminals move the cursor with "\t" followed by the column and row as two digits each
+void text_frontend::flush() {
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            char c = pending[row][column];
+            if (synced && c == shown[row][column]) {
+                continue;
+            }
+            terminal << '\t'
+                     << static_cast<char>('0' + column / 10) << static_cast<char>('0' + column % 10)
+                     << static_cast<char>('0' + row / 10) << static_cast<char>('0' + row % 10)
+                     << c;
+            shown[row][column] = c;
+        }
+    }
+    synced = true;
+    window.flush();
+}
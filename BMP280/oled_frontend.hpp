@@ -0,0 +1,137 @@
+/**
+ * @file oled_frontend.hpp
+ * @brief Display front-end for the outfit recommendation that only sends what changed to the OLED.
+ *
+ * Redrawing the whole terminal with "\f" and flushing a hwlib::glcd_oled sends the complete 1 KB frame
+ * buffer over the bit-banged I2C bus, even when nothing changed. oled_buffered_window keeps a copy of what
+ * the display shows and only sends the bytes that differ, text_frontend only redraws the character cells
+ * whose character changed.
+ */
+
+#ifndef OLED_FRONTEND_HPP
+#define OLED_FRONTEND_HPP
+
+#include "hwlib.hpp"
+
+/**
+ * @class oled_buffered_window
+ * @brief 128x64 SSD1306 OLED on I2C that only sends changed bytes when flushed.
+ *
+ * The SSD1306 memory is organized in 8 pages of 8 pixel rows, each byte is a column of 8 pixels. For each page
+ * the window remembers the range of columns that was written since the last flush. flush() compares that range
+ * with the bytes the display already shows and sends only the part that differs, using the column and page
+ * address commands of the SSD1306 in horizontal addressing mode.
+ **/
+class oled_buffered_window : public hwlib::window {
+
+public:
+    static constexpr int width = 128;       /**< Width in pixels */
+    static constexpr int height = 64;       /**< Height in pixels */
+    static constexpr int pages = height / 8; /**< Number of 8 pixel high pages */
+
+private:
+    hwlib::i2c_bus& bus;            /**< hwlib i2c bus the display is connected to */
+    uint8_t i2c_address;            /**< i2c address of the display */
+
+    uint8_t buffer[pages * width];  /**< Frame buffer that is drawn into */
+    uint8_t shown[pages * width];   /**< What the display shows since the last flush */
+    int16_t dirty_first[pages];     /**< First written column of each page, width if clean */
+    int16_t dirty_last[pages];      /**< Last written column of each page */
+    bool synced;                    /**< False until the first flush, the display memory is unknown before that */
+
+    uint32_t byte_count;            /**< Bytes sent to the display, including commands */
+
+    void write_implementation(hwlib::xy pos, hwlib::color col) override;
+    void clear_implementation(hwlib::color col) override;
+
+    /**
+     * @brief Send the initialization commands of the SSD1306.
+     */
+    void initialize();
+
+public:
+    /**
+     * @brief Constructor for the oled_buffered_window class, initializes the display.
+     * @param bus The hwlib i2c bus the display is connected to.
+     * @param i2c_address The i2c address of the display. Default is 0x3C.
+     */
+    oled_buffered_window(hwlib::i2c_bus& bus, uint8_t i2c_address = 0x3C);
+
+    /**
+     * @brief Send the bytes that changed since the last flush to the display.
+     */
+    void flush() override;
+
+    /**
+     * @brief Get the number of bytes sent to the display.
+     * @return The number of bytes since construction, including command and control bytes.
+     */
+    uint32_t bytesSent() const;
+};
+
+/**
+ * @class text_frontend
+ * @brief Grid of characters on a terminal that only redraws the cells that changed.
+ *
+ * Text is first placed in a pending grid with clear() and print(), flush() then writes every cell that differs
+ * from the last flush to the terminal and flushes the window.
+ **/
+class text_frontend {
+
+public:
+    static constexpr int columns = 16; /**< Characters per line, for an 8x8 font on a 128 pixel wide display */
+    static constexpr int rows = 8;     /**< Lines, for an 8x8 font on a 64 pixel high display */
+
+private:
+    hwlib::ostream& terminal;          /**< Terminal that draws the characters */
+    hwlib::window& window;             /**< Window of the terminal, flushed after drawing */
+    char pending[rows][columns];       /**< Text to show at the next flush */
+    char shown[rows][columns];         /**< Text that was drawn at the last flush */
+    bool synced;                       /**< False until the first flush */
+
+public:
+    /**
+     * @brief Constructor for the text_frontend class.
+     * @param terminal The terminal that draws on the window, for example a hwlib::terminal_from.
+     * @param window The window of the terminal.
+     */
+    text_frontend(hwlib::ostream& terminal, hwlib::window& window);
+
+    /**
+     * @brief Fill the pending grid with spaces.
+     */
+    void clear();
+
+    /**
+     * @brief Place text in the pending grid, text beyond the end of the line is cut off.
+     * @param column The column of the first character.
+     * @param row The row.
+     * @param text The text.
+     * @return The column after the last character.
+     */
+    int print(int column, int row, const char* text);
+
+    /**
+     * @brief Place a number in the pending grid.
+     * @param column The column of the first digit or minus sign.
+     * @param row The row.
+     * @param value The number.
+     * @return The column after the last digit.
+     */
+    int print(int column, int row, int32_t value);
+
+    /**
+     * @brief Place text in the pending grid, wrapped at spaces.
+     * @param row The row of the first line.
+     * @param text The text.
+     * @return The row after the last line of the text.
+     */
+    int printWrapped(int row, const char* text);
+
+    /**
+     * @brief Draw the cells that changed since the last flush and flush the window.
+     */
+    void flush();
+};
+
+#endif // OLED_FRONTEND_HPP
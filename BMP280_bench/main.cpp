@@ -0,0 +1,1072 @@
+// Host benchmarks for the BMP280 library, build and run with 'make run'
+
+#include <string.h>
+#include <math.h>
+#include <thread>
+#include <vector>
+#include "hwlib.hpp"
+#include "bmp280.hpp"
+#include "bmp280_static.hpp"
+#include "bmp280_stream.hpp"
+#include "bmp280_manager.hpp"
+#include "bmp280_sample_log.hpp"
+#include "bmp280_sim.hpp"
+#include "bmp280_temperature_lut.hpp"
+#include "bmp280_batch.hpp"
+#include "bmp280_altitude.hpp"
+#include "bmp280_reporter.hpp"
+#include "bmp280_protocol.hpp"
+#include "bmp280_archive.hpp"
+#include "bmp280_replay.hpp"
+#include "bmp280_filter.hpp"
+#include "bmp280_scheduler.hpp"
+#include "bmp280_window.hpp"
+
+const bmp280_calibration_data& example_calibration = bmp280_sim::example_calibration;
+
+// Small deterministic pseudo random generator, so every run uses the same traces
+class xorshift {
+    uint32_t state;
+public:
+    xorshift(uint32_t seed) : state(seed) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Roughly normal distributed noise with the given standard deviation, the sum of 4 uniform values
+    int32_t noise(int32_t sigma) {
+        int32_t sum = 0;
+        for (int i = 0; i < 4; i++) {
+            sum += static_cast<int32_t>(next() % 2001) - 1000;
+        }
+        return sum * sigma / 1155;
+    }
+};
+
+// Triangle wave between -amplitude and amplitude, cheap stand-in for slow daily cycles
+int32_t triangle(uint32_t t, uint32_t period, int32_t amplitude) {
+    int32_t phase = static_cast<int32_t>(t % period);
+    int32_t half = static_cast<int32_t>(period / 2);
+    int32_t value = phase < half ? phase : static_cast<int32_t>(period) - phase;
+    return (value * 4 - static_cast<int32_t>(period)) * amplitude / static_cast<int32_t>(period);
+}
+
+// A raw trace, generated one sample at a time
+// Around 25 degrees Celsius 1 raw temperature LSB is 0.0003 degrees, 1 raw pressure LSB is about 0.16 Pa
+class trace {
+public:
+    virtual bmp280_raw_sample sample(uint32_t n) = 0;
+    virtual const char* name() = 0;
+};
+
+// Weather station in forced mode every 20 s, x1 oversampling: 16-bit values, so the low 4 bits are 0
+class weather_trace : public trace {
+    xorshift random{1};
+public:
+    bmp280_raw_sample sample(uint32_t n) override {
+        uint32_t seconds = n * 20;
+        int32_t t = 519888 + triangle(seconds, 86400, 15000) + random.noise(30);
+        int32_t p = 415148 + triangle(seconds, 7 * 86400, 6000) + random.noise(8);
+        return bmp280_raw_sample{static_cast<uint32_t>(t) & ~0xFu, static_cast<uint32_t>(p) & ~0xFu};
+    }
+    const char* name() override { return "weather, forced x1 every 20 s"; }
+};
+
+// Normal mode at about 26 Hz with x16 pressure oversampling and filter x16: 20-bit values with low noise
+class altimeter_trace : public trace {
+    xorshift random{2};
+public:
+    bmp280_raw_sample sample(uint32_t n) override {
+        int32_t t = 519888 + triangle(n, 26 * 3600, 300) + random.noise(3);
+        int32_t p = 415148 + triangle(n, 26 * 120, 2400) + random.noise(2);
+        return bmp280_raw_sample{static_cast<uint32_t>(t), static_cast<uint32_t>(p)};
+    }
+    const char* name() override { return "altimeter, normal mode x16 at 26 Hz"; }
+};
+
+// Prints value / 100 with two decimals
+void printHundredths(uint32_t value) {
+    hwlib::cout << value / 100 << "." << hwlib::setw(2) << hwlib::setfill('0') << value % 100;
+}
+
+// Fills a log with more samples than it can hold and reports how much room each sample takes
+template<size_t block_size, size_t block_count>
+void benchmarkSampleLog(trace& source, uint32_t sample_count) {
+    bmp280_sample_log<block_size, block_count> log(example_calibration);
+
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t n = 0; n < sample_count; n++) {
+        log.append(source.sample(n));
+    }
+    uint_fast64_t append_us = hwlib::now_us() - start;
+
+    // Decode everything that's still in the log, one block at a time
+    static bmp280_sample_int samples[block_size];
+    start = hwlib::now_us();
+    uint32_t decoded = 0;
+    for (size_t block = 0; block < log.blocksUsed(); block++) {
+        decoded += log.readBlockCompensated(block, samples);
+    }
+    uint_fast64_t decode_us = hwlib::now_us() - start;
+
+    uint32_t bytes = block_count * (block_size + 8);
+    hwlib::cout << "  " << source.name() << ", " << block_count << " blocks of " << block_size << " bytes" << hwlib::endl;
+    hwlib::cout << "    samples kept:        " << log.size() << " of " << sample_count << hwlib::endl;
+    hwlib::cout << "    data bytes / sample: ";
+    printHundredths(static_cast<uint32_t>(log.bytesUsed() * 100 / log.size()));
+    hwlib::cout << hwlib::endl << "    RAM bytes / sample:  ";
+    printHundredths(bytes * 100 / log.size());
+    hwlib::cout << " (raw uint32_t pairs: 8.00)" << hwlib::endl;
+    hwlib::cout << "    append:              " << static_cast<uint32_t>(append_us * 1000 / sample_count) << " ns / sample" << hwlib::endl;
+    hwlib::cout << "    decode + compensate: " << static_cast<uint32_t>(decode_us * 1000 / decoded) << " ns / sample" << hwlib::endl << hwlib::endl;
+}
+
+// Prints the bus usage since the last reset of the counters, per sample
+template<typename bus_type>
+void printBusUsage(const char* name, bus_type& bus, uint32_t samples) {
+    hwlib::cout << "  " << name << ": ";
+    printHundredths(bus.transactions() * 100 / samples);
+    hwlib::cout << " transactions, ";
+    printHundredths(bus.bytes() * 100 / samples);
+    hwlib::cout << " bytes" << hwlib::endl;
+    bus.resetCounters();
+}
+
+// A simulated sensor with slowly changing temperature and pressure
+void setupSimulation(bmp280_sim& sim) {
+    sim.setTemperatureWaveform(bmp280_sim_waveform{519888, 3000, 10000000, 20});
+    sim.setPressureWaveform(bmp280_sim_waveform{415148, 2000, 60000000, 20});
+}
+
+// Measures how many transactions and bytes each way of reading a sample puts on the bus
+void benchmarkBusUsage() {
+    const uint32_t samples = 50;
+
+    bmp280_sim sim;
+    setupSimulation(sim);
+    bmp280_sim_i2c_bus bus(sim);
+
+    hwlib::cout << "Bus usage per call or sample (simulated BMP280)" << hwlib::endl << "-----" << hwlib::endl;
+
+    bmp280 sensor(bus);
+    printBusUsage("constructor", bus, 1);
+
+    sensor.initialize();
+    printBusUsage("initialize()", bus, 1);
+
+    sensor.setup();
+    printBusUsage("setup()", bus, 1);
+
+    bmp280_static<SAMPLING_X1, SAMPLING_X1, FILTER_OFF> static_sensor(bus);
+    bus.resetCounters();
+    static_sensor.setup();
+    printBusUsage("bmp280_static::setup()", bus, 1);
+
+    sensor.snapshot();
+    printBusUsage("snapshot()", bus, 1);
+
+    // Cold boot with a stored calibration blob, up to the first compensated sample
+    bmp280_calibration_blob blob = sensor.getCalibrationBlob();
+    bus.resetCounters();
+    bmp280_static<SAMPLING_X1, SAMPLING_X1, FILTER_OFF> fast_boot_sensor(bus, blob);
+    fast_boot_sensor.setup();
+    fast_boot_sensor.startMeasurement();
+    hwlib::wait_us(fast_boot_sensor.remainingMeasurementTime());
+    while (!fast_boot_sensor.poll()) {}
+    fast_boot_sensor.collectInt();
+    printBusUsage("boot to first sample, stored calibration", bus, 1);
+
+    bmp280_static<SAMPLING_X1, SAMPLING_X1, FILTER_OFF> cold_boot_sensor(bus);
+    cold_boot_sensor.setup();
+    cold_boot_sensor.startMeasurement();
+    hwlib::wait_us(cold_boot_sensor.remainingMeasurementTime());
+    while (!cold_boot_sensor.poll()) {}
+    cold_boot_sensor.collectInt();
+    printBusUsage("boot to first sample, calibration from the sensor", bus, 1);
+
+    hwlib::wait_us(measurementTimeUs(SAMPLING_X1, SAMPLING_X1));
+    bus.resetCounters();
+    for (uint32_t i = 0; i < samples; i++) {
+        sensor.getTemperature();
+        sensor.getPressure();
+    }
+    printBusUsage("getTemperature() + getPressure()", bus, samples);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        sensor.readSample();
+    }
+    printBusUsage("readSample()", bus, samples);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        sensor.startMeasurement();
+        hwlib::wait_us(sensor.remainingMeasurementTime());
+        while (!sensor.poll()) {}
+        sensor.collectInt();
+    }
+    printBusUsage("forced: startMeasurement() + poll() + collectInt()", bus, samples);
+
+    // Normal mode at the highest rate, the service loop runs as fast as it can
+    bmp280_stream<64> stream(sensor);
+    stream.start(STANDBY_MS_1, FILTER_X4);
+    bus.resetCounters();
+    uint_fast64_t end = hwlib::now_us() + 500000;
+    uint32_t conversions = sim.conversions();
+    uint32_t streamed = 0;
+    bmp280_sample_int batch[64];
+    while (hwlib::now_us() < end) {
+        stream.service();
+        streamed += stream.read(batch, 64);
+    }
+    conversions = sim.conversions() - conversions;
+    stream.stop();
+    printBusUsage("normal: bmp280_stream::service()", bus, streamed);
+    hwlib::cout << "    " << streamed << " samples from " << conversions << " conversions in 0.5 s, "
+                << stream.lostCount() << " lost" << hwlib::endl << hwlib::endl;
+
+    // The same sensor over SPI, every burst is a single transaction
+    bmp280_sim spi_sim;
+    setupSimulation(spi_sim);
+    bmp280_sim_spi_bus spi_bus(spi_sim);
+    bmp280_spi_transport transport(spi_bus, spi_bus.chipSelect());
+
+    hwlib::cout << "Bus usage per call or sample (simulated BMP280 on SPI)" << hwlib::endl << "-----" << hwlib::endl;
+
+    bmp280 spi_sensor(transport);
+    spi_sensor.initialize();
+    printBusUsage("initialize()", spi_bus, 1);
+
+    spi_sensor.setup();
+    printBusUsage("setup()", spi_bus, 1);
+
+    hwlib::wait_us(measurementTimeUs(SAMPLING_X1, SAMPLING_X1));
+    spi_bus.resetCounters();
+    for (uint32_t i = 0; i < samples; i++) {
+        spi_sensor.readSample();
+    }
+    printBusUsage("readSample()", spi_bus, samples);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        spi_sensor.startMeasurement();
+        hwlib::wait_us(spi_sensor.remainingMeasurementTime());
+        while (!spi_sensor.poll()) {}
+        spi_sensor.collectInt();
+    }
+    printBusUsage("forced: startMeasurement() + poll() + collectInt()", spi_bus, samples);
+
+    // Both buses must give the same compensated values for the same raw data
+    bmp280_raw_sample raw = spi_sensor.readSampleRaw();
+    int32_t t_fine;
+    bool same = spi_sensor.getCalibrationData().dig_T1 == sensor.getCalibrationData().dig_T1
+        && compensateTemperatureInt(spi_sensor.getCalibrationData(), raw.temperature, t_fine)
+            == compensateTemperatureInt(sensor.getCalibrationData(), raw.temperature, t_fine)
+        && spi_sensor.snapshot().get(BMP280_CHIP_ID_REG) == 0x58;
+    hwlib::cout << "  calibration and chip ID over SPI: " << (same ? "ok" : "WRONG") << hwlib::endl << hwlib::endl;
+
+    // A BME280 reads the humidity in the same burst as the temperature and pressure
+    bmp280_sim bme_sim;
+    setupSimulation(bme_sim);
+    bme_sim.enableHumidity();
+    bmp280_sim_i2c_bus bme_bus(bme_sim);
+
+    hwlib::cout << "Bus usage per call or sample (simulated BME280 on I2C)" << hwlib::endl << "-----" << hwlib::endl;
+
+    bmp280 bme_sensor(bme_bus);
+    bme_sensor.initialize();
+    printBusUsage("initialize()", bme_bus, 1);
+
+    bme_sensor.setup();
+    hwlib::wait_us(bme_sensor.measurementTime());
+    bme_bus.resetCounters();
+    for (uint32_t i = 0; i < samples; i++) {
+        bme_sensor.readSampleInt();
+    }
+    printBusUsage("readSampleInt()", bme_bus, samples);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        bme_sensor.readHumiditySampleInt();
+    }
+    printBusUsage("readHumiditySampleInt()", bme_bus, samples);
+
+    // The reads above only count bytes, check the humidity of a finished conversion of constant raw values
+    const uint32_t raw_temp = 519888;
+    const uint32_t raw_hum = 28000;
+    bme_sim.setTemperatureWaveform(bmp280_sim_waveform{raw_temp, 0, 0, 0});
+    bme_sim.setHumidityWaveform(bmp280_sim_waveform{raw_hum, 0, 0, 0});
+    bme_sensor.setOversampling(SAMPLING_X16, SAMPLING_X1);
+    bme_sensor.startMeasurement();
+    hwlib::wait_us(bme_sensor.remainingMeasurementTime());
+    while (!bme_sensor.poll()) {}
+    bme280_sample_int humidity_sample = bme_sensor.collectHumiditySampleInt();
+    compensateTemperatureInt(example_calibration, raw_temp, t_fine);
+    uint32_t expected = compensateHumidityInt(bmp280_sim::example_humidity_calibration, raw_hum, t_fine);
+    hwlib::cout << "  chip: " << (bme_sensor.hasHumidity() ? "BME280" : "BMP280") << ", humidity "
+                << (humidity_sample.humidity >> 10) << " %RH, expected " << (expected >> 10) << " %RH: "
+                << (humidity_sample.humidity == expected ? "ok" : "WRONG") << hwlib::endl << hwlib::endl;
+}
+
+// Compares reading several sensors one after another with bmp280_manager
+void benchmarkManager() {
+    const uint32_t cycles = 20;
+    const size_t sensor_count = 4;
+
+    bmp280_sim sims[sensor_count];
+    bmp280_sim_i2c_bus buses[sensor_count] = {sims[0], sims[1], sims[2], sims[3]};
+    bmp280 sensor0(buses[0]), sensor1(buses[1]), sensor2(buses[2]), sensor3(buses[3]);
+    bmp280* sensors[sensor_count] = {&sensor0, &sensor1, &sensor2, &sensor3};
+
+    bmp280_manager<sensor_count> manager;
+    for (size_t i = 0; i < sensor_count; i++) {
+        setupSimulation(sims[i]);
+        sensors[i]->setup();
+        manager.add(*sensors[i]);
+    }
+
+    hwlib::cout << "Sampling " << sensor_count << " sensors (simulated BMP280)" << hwlib::endl << "-----" << hwlib::endl;
+
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        for (size_t i = 0; i < sensor_count; i++) {
+            sensors[i]->startMeasurement();
+            hwlib::wait_us(sensors[i]->remainingMeasurementTime());
+            while (!sensors[i]->poll()) {}
+            sensors[i]->collectInt();
+        }
+    }
+    hwlib::cout << "  one after another: " << static_cast<uint32_t>((hwlib::now_us() - start) / cycles) << " us / cycle" << hwlib::endl;
+
+    bmp280_timed_sample samples[sensor_count];
+    start = hwlib::now_us();
+    for (uint32_t cycle = 0; cycle < cycles; cycle++) {
+        manager.sampleAll(samples);
+    }
+    hwlib::cout << "  bmp280_manager:    " << static_cast<uint32_t>((hwlib::now_us() - start) / cycles) << " us / cycle" << hwlib::endl;
+    hwlib::cout << "  single conversion: " << measurementTimeUs(SAMPLING_X1, SAMPLING_X1) << " us (datasheet maximum)" << hwlib::endl;
+
+    // A sensor at an address nobody answers reads as 0xFF, so it looks like it is measuring forever
+    bmp280 missing(buses[0], 0x77);
+    missing.setup();
+    bmp280_manager<2> partial;
+    partial.add(sensor0);
+    partial.add(missing);
+    start = hwlib::now_us();
+    size_t count = partial.sampleAll(samples);
+    hwlib::cout << "  one sensor missing: " << count << " of " << partial.size() << " samples, sensor "
+                << samples[0].sensor << ", " << static_cast<uint32_t>(hwlib::now_us() - start) << " us" << hwlib::endl << hwlib::endl;
+}
+
+// Measures the cost of the compensation formulas alone, without any bus traffic
+void benchmarkCompensation() {
+    const uint32_t calls = 1000000;
+    xorshift random(3);
+    static uint32_t raw_temp[1024];
+    static uint32_t raw_press[1024];
+    for (int i = 0; i < 1024; i++) {
+        raw_temp[i] = 519888 + random.next() % 20000;
+        raw_press[i] = 415148 + random.next() % 20000;
+    }
+
+    hwlib::cout << "Compensation cost (host)" << hwlib::endl << "-----" << hwlib::endl;
+
+    volatile double double_sink;
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        int32_t t_fine;
+        double_sink = compensateTemperature(example_calibration, raw_temp[i % 1024], t_fine);
+        double_sink = compensatePressure(example_calibration, raw_press[i % 1024], t_fine);
+    }
+    hwlib::cout << "  double:  " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / sample" << hwlib::endl;
+
+    volatile uint32_t int_sink;
+    start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        int32_t t_fine;
+        int_sink = compensateTemperatureInt(example_calibration, raw_temp[i % 1024], t_fine);
+        int_sink = compensatePressureInt(example_calibration, raw_press[i % 1024], t_fine);
+    }
+    hwlib::cout << "  integer: " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / sample" << hwlib::endl;
+
+    bmp280_compensation_plan plan;
+    buildCompensationPlan(example_calibration, plan);
+    volatile float float_sink;
+    start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        int32_t t_fine;
+        float_sink = compensateTemperature(plan, raw_temp[i % 1024], t_fine);
+        float_sink = compensatePressure(plan, raw_press[i % 1024], t_fine);
+    }
+    hwlib::cout << "  plan:    " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / sample" << hwlib::endl;
+
+    bmp280_temperature_lut<64> lut(example_calibration);
+    start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        int32_t t_fine;
+        float_sink = lut.compensate(raw_temp[i % 1024], t_fine);
+    }
+    hwlib::cout << "  lut<64> temperature only: " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / sample" << hwlib::endl;
+    (void)double_sink;
+    (void)int_sink;
+    (void)float_sink;
+
+    // Largest difference with the double formulas over -40..85 degrees Celsius and 300..1100 hPa
+    double plan_temp_error = 0;
+    double plan_press_error = 0;
+    double lut_error = 0;
+    for (uint32_t raw_t = 0; raw_t < (1u << 20); raw_t += 61) {
+        int32_t t_fine;
+        int32_t plan_t_fine;
+        double temperature = compensateTemperature(example_calibration, raw_t, t_fine);
+        if (temperature < -40 || temperature > 85) {
+            continue;
+        }
+        double error = temperature - compensateTemperature(plan, raw_t, plan_t_fine);
+        plan_temp_error = error > plan_temp_error ? error : (-error > plan_temp_error ? -error : plan_temp_error);
+        error = temperature - lut.compensate(raw_t, plan_t_fine);
+        lut_error = error > lut_error ? error : (-error > lut_error ? -error : lut_error);
+
+        for (uint32_t raw_p = 0; raw_p < (1u << 20); raw_p += 4099) {
+            double pressure = compensatePressure(example_calibration, raw_p, t_fine);
+            if (pressure < 30000 || pressure > 110000) {
+                continue;
+            }
+            error = pressure - compensatePressure(plan, raw_p, t_fine);
+            plan_press_error = error > plan_press_error ? error : (-error > plan_press_error ? -error : plan_press_error);
+        }
+    }
+    hwlib::cout << "  plan max error: " << static_cast<uint32_t>(plan_temp_error * 1000000) << " uC, "
+                << static_cast<uint32_t>(plan_press_error * 1000) << " mPa" << hwlib::endl;
+    hwlib::cout << "  lut<64> max error: " << static_cast<uint32_t>(lut_error * 1000000) << " uC (bound "
+                << static_cast<uint32_t>(lut.maxError() * 1000000) << " uC)" << hwlib::endl << hwlib::endl;
+}
+
+// Compares the fast altitude functions with the same formulas using libm
+void benchmarkAltitude() {
+    const uint32_t calls = 1000000;
+    static float pressures[1024];
+    xorshift random(9);
+    for (int i = 0; i < 1024; i++) {
+        pressures[i] = 30000.0f + static_cast<float>(random.next() % 8000000) / 100.0f;
+    }
+
+    hwlib::cout << "Altitude from pressure (host)" << hwlib::endl << "-----" << hwlib::endl;
+
+    volatile double double_sink;
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        double_sink = pressureToAltitudeExact(pressures[i % 1024]);
+    }
+    hwlib::cout << "  pow():   " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / call" << hwlib::endl;
+
+    volatile float float_sink;
+    start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        float_sink = 44330.0f * (1.0f - powf(pressures[i % 1024] / BMP280_SEA_LEVEL_PRESSURE, 0.190295f));
+    }
+    hwlib::cout << "  powf():  " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / call" << hwlib::endl;
+
+    start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        float_sink = pressureToAltitude(pressures[i % 1024]);
+    }
+    hwlib::cout << "  fast:    " << static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls) << " ns / call" << hwlib::endl;
+    (void)double_sink;
+    (void)float_sink;
+
+    double altitude_error = 0;
+    double sea_level_error = 0;
+    for (uint32_t pascal = 30000; pascal <= 110000; pascal++) {
+        double exact = pressureToAltitudeExact(pascal);
+        double error = fabs(exact - pressureToAltitude(static_cast<float>(pascal)));
+        altitude_error = error > altitude_error ? error : altitude_error;
+        error = fabs(seaLevelPressureExact(pascal, exact) - seaLevelPressure(static_cast<float>(pascal), static_cast<float>(exact)));
+        sea_level_error = error > sea_level_error ? error : sea_level_error;
+    }
+    hwlib::cout << "  fast max error, 300..1100 hPa: " << static_cast<uint32_t>(altitude_error * 1000) << " mm, sea level pressure "
+                << static_cast<uint32_t>(sea_level_error * 1000) << " mPa" << hwlib::endl << hwlib::endl;
+}
+
+// Compares compensateBatch() with calling the scalar double functions in a loop
+void benchmarkBatch() {
+    const size_t count = 1 << 20;
+    const int rounds = 8;
+    static uint32_t raw_temp[count];
+    static uint32_t raw_press[count];
+    static double temperature[count];
+    static double pressure[count];
+    static double batch_temperature[count];
+    static double batch_pressure[count];
+
+    xorshift random(5);
+    for (size_t i = 0; i < count; i++) {
+        raw_temp[i] = 400000 + random.next() % 300000;
+        raw_press[i] = 200000 + random.next() % 500000;
+    }
+
+    hwlib::cout << "Batch compensation of " << static_cast<uint32_t>(count) << " samples (host, "
+                << compensateBatchInstructionSet() << ")" << hwlib::endl << "-----" << hwlib::endl;
+
+    uint_fast64_t start = hwlib::now_us();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            int32_t t_fine;
+            temperature[i] = compensateTemperature(example_calibration, raw_temp[i], t_fine);
+            pressure[i] = compensatePressure(example_calibration, raw_press[i], t_fine);
+        }
+    }
+    uint_fast64_t scalar_us = (hwlib::now_us() - start) / rounds;
+
+    start = hwlib::now_us();
+    for (int round = 0; round < rounds; round++) {
+        compensateBatch(example_calibration, raw_temp, raw_press, count, batch_temperature, batch_pressure);
+    }
+    uint_fast64_t batch_us = (hwlib::now_us() - start) / rounds;
+
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (memcmp(&temperature[i], &batch_temperature[i], sizeof(double)) != 0
+            || memcmp(&pressure[i], &batch_pressure[i], sizeof(double)) != 0) {
+            mismatches++;
+        }
+    }
+
+    hwlib::cout << "  scalar: " << static_cast<uint32_t>(count * 1000 / scalar_us) << " ksamples / s" << hwlib::endl;
+    hwlib::cout << "  batch:  " << static_cast<uint32_t>(count * 1000 / batch_us) << " ksamples / s" << hwlib::endl;
+    hwlib::cout << "  results that differ from the scalar functions: " << mismatches << hwlib::endl << hwlib::endl;
+}
+
+// Cross-checks the driver's own instrumentation against the simulated bus and prints it.
+// On SPI every register burst is exactly one transaction, so the counters must match.
+void benchmarkInstrumentation() {
+    const uint32_t samples = 50;
+
+    bmp280_sim sim;
+    setupSimulation(sim);
+    bmp280_sim_spi_bus bus(sim);
+    bmp280_spi_transport transport(bus, bus.chipSelect());
+    bmp280 sensor(transport);
+    sensor.setup();
+    hwlib::wait_us(measurementTimeUs(SAMPLING_X1, SAMPLING_X1));
+
+    bus.resetCounters();
+    sensor.resetStats();
+    for (uint32_t i = 0; i < samples; i++) {
+        sensor.getTemperature();
+        sensor.getPressure();
+        sensor.readSampleInt();
+    }
+    sensor.printStats();
+
+#ifdef BMP280_INSTRUMENTATION
+    const bmp280_stats& stats = sensor.getStats();
+    hwlib::cout << "Simulated bus: " << bus.transactions() << " transactions, " << bus.bytes() << " bytes ("
+                << ((stats.transactions == bus.transactions() && stats.bytes == bus.bytes()) ? "matches" : "DOES NOT MATCH")
+                << ")" << hwlib::endl << hwlib::endl;
+#endif
+}
+
+// Counts how many samples of each trace a bmp280_reporter lets through
+void benchmarkReporter() {
+    const uint32_t samples = 20000;
+    weather_trace weather;
+    altimeter_trace altimeter;
+    trace* traces[] = {&weather, &altimeter};
+    const uint32_t interval_us[] = {20000000, 38462};
+
+    hwlib::cout << "bmp280_reporter, 0.1 C / 0.05 C hysteresis, 20 ppm, heartbeat 60 s" << hwlib::endl << "-----" << hwlib::endl;
+    for (int i = 0; i < 2; i++) {
+        bmp280_reporter reporter(bmp280_deadband{10, 0, 5, 60000}, bmp280_deadband{0, 20, 0, 60000});
+        uint32_t temperature_reports = 0;
+        uint32_t pressure_reports = 0;
+        for (uint32_t n = 0; n < samples; n++) {
+            bmp280_raw_sample raw = traces[i]->sample(n);
+            bmp280_sample_int sample;
+            int32_t t_fine;
+            sample.temperature = compensateTemperatureInt(example_calibration, raw.temperature, t_fine);
+            sample.pressure = compensatePressureInt(example_calibration, raw.pressure, t_fine);
+            uint8_t flags = reporter.update(sample, static_cast<uint_fast64_t>(n) * interval_us[i]);
+            temperature_reports += (flags & REPORT_TEMPERATURE) ? 1 : 0;
+            pressure_reports += (flags & REPORT_PRESSURE) ? 1 : 0;
+        }
+        hwlib::cout << "  " << traces[i]->name() << ": " << temperature_reports << " temperature and "
+                    << pressure_reports << " pressure reports for " << samples << " samples" << hwlib::endl;
+    }
+    hwlib::cout << hwlib::endl;
+}
+
+void benchmarkSampleLogs() {
+    hwlib::cout << "bmp280_sample_log" << hwlib::endl << "-----" << hwlib::endl;
+
+    weather_trace weather;
+    altimeter_trace altimeter;
+    benchmarkSampleLog<256, 64>(weather, 20000);
+    benchmarkSampleLog<256, 64>(altimeter, 20000);
+    benchmarkSampleLog<1024, 16>(altimeter, 20000);
+}
+
+// Counts the characters written to it, to measure the size of the text output
+class counting_ostream : public hwlib::ostream {
+public:
+    uint32_t count = 0;
+    void putc(char) override { count++; }
+};
+
+void benchmarkProtocol() {
+    const uint32_t samples = 20000;
+    altimeter_trace altimeter;
+
+    hwlib::cout << "bmp280_protocol, " << altimeter.name() << hwlib::endl << "-----" << hwlib::endl;
+
+    // The same lines as printRawData() and printCompensatedData()
+    counting_ostream text;
+    altimeter_trace text_source;
+    for (uint32_t n = 0; n < samples; n++) {
+        bmp280_raw_sample raw = text_source.sample(n);
+        int32_t t_fine;
+        double temperature = compensateTemperature(example_calibration, raw.temperature, t_fine);
+        double pressure = compensatePressure(example_calibration, raw.pressure, t_fine);
+        text << "Raw Temperature Data: " << hwlib::dec << raw.temperature << "\n";
+        text << "Raw Pressure Data: " << hwlib::dec << raw.pressure << "\n" << "\n";
+        text << "Compensated Temperature: " << static_cast<int>(temperature) << " _C" << "\n";
+        text << "Compensated Pressure: " << static_cast<int>(pressure) << " Pa" << "\n";
+    }
+
+    // Binary frames with a calibration frame every 256 sample frames, as main.cpp sends them
+    static uint8_t stream[samples * 8];
+    uint32_t size = 0;
+    bmp280_frame_encoder encoder;
+    uint32_t frames = 0;
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t n = 0; n < samples; n++) {
+        if (n % 8 == 0 && frames % 256 == 0) {
+            int frame_size = encoder.encodeCalibration(example_calibration, 38462);
+            memcpy(stream + size, encoder.getFrame(), frame_size);
+            size += frame_size;
+        }
+        int frame_size = encoder.add(altimeter.sample(n));
+        if (frame_size > 0) {
+            memcpy(stream + size, encoder.getFrame(), frame_size);
+            size += frame_size;
+            frames++;
+        }
+    }
+    uint_fast64_t encode_us = hwlib::now_us() - start;
+
+    // 10 bits per byte on the UART
+    hwlib::cout << "  text:   ";
+    printHundredths(text.count * 100 / samples);
+    hwlib::cout << " bytes / sample, " << 115200 / 10 * samples / text.count << " samples / s at 115200 baud" << hwlib::endl;
+    hwlib::cout << "  binary: ";
+    printHundredths(size * 100 / samples);
+    hwlib::cout << " bytes / sample, " << 115200 / 10 * samples / size << " samples / s at 115200 baud, "
+                << static_cast<uint32_t>(encode_us * 1000 / samples) << " ns / sample to encode" << hwlib::endl;
+    hwlib::cout << "  ";
+    printHundredths(text.count * 100 / size);
+    hwlib::cout << " times more samples over the same link" << hwlib::endl;
+
+    // Decode the stream and check that every raw sample survived
+    altimeter_trace reference;
+    bmp280_frame_decoder decoder;
+    bmp280_calibration_data calibration;
+    bmp280_raw_sample decoded[BMP280_FRAME_MAX_RECORDS];
+    uint32_t period_us = 0;
+    uint32_t received = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        if (!decoder.feed(stream[i])) {
+            continue;
+        }
+        if (decoder.getType() == BMP280_FRAME_CALIBRATION) {
+            decodeCalibrationFrame(decoder.getPayload(), decoder.getPayloadLength(), calibration, period_us);
+            mismatches += memcmp(&calibration, &example_calibration, offsetof(bmp280_calibration_data, t_fine)) != 0 ? 1 : 0;
+            continue;
+        }
+        uint16_t sequence;
+        int count = decodeSampleFrame(decoder.getPayload(), decoder.getPayloadLength(), sequence, decoded);
+        mismatches += sequence != static_cast<uint16_t>(received) ? 1 : 0;
+        for (int j = 0; j < count; j++, received++) {
+            bmp280_raw_sample raw = reference.sample(received);
+            mismatches += (raw.temperature != decoded[j].temperature || raw.pressure != decoded[j].pressure) ? 1 : 0;
+        }
+    }
+    hwlib::cout << "  decoded " << received << " samples, " << mismatches << " mismatches" << hwlib::endl;
+
+    // Corrupt one byte in every 1000, the decoder drops those frames and finds the next one
+    xorshift random(3);
+    for (uint32_t i = 500; i < size; i += 1000) {
+        stream[i] ^= static_cast<uint8_t>(1 + random.next() % 255);
+    }
+    bmp280_frame_decoder noisy;
+    received = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        if (noisy.feed(stream[i]) && noisy.getType() == BMP280_FRAME_SAMPLES) {
+            uint16_t sequence;
+            received += decodeSampleFrame(noisy.getPayload(), noisy.getPayloadLength(), sequence, decoded);
+        }
+    }
+    hwlib::cout << "  with " << size / 1000 << " corrupted bytes: " << noisy.frameCount() << " frames, "
+                << noisy.crcErrorCount() << " CRC errors, " << samples - received << " samples lost" << hwlib::endl << hwlib::endl;
+}
+
+void benchmarkReplay() {
+    const uint64_t samples = 4000000;
+    altimeter_trace altimeter;
+
+    // An archive of 42 hours at 26 Hz, replayed into one minute buckets
+    std::vector<uint8_t> archive(BMP280_ARCHIVE_HEADER_LENGTH + samples * BMP280_RECORD_LENGTH);
+    bmp280_archive_header header = {1, 38462, 0, samples, {{0}}};
+    serializeCalibration(example_calibration, header.calibration);
+    writeArchiveHeader(header, archive.data());
+    for (uint64_t n = 0; n < samples; n++) {
+        packRawSample(altimeter.sample(static_cast<uint32_t>(n)), archive.data() + BMP280_ARCHIVE_HEADER_LENGTH + n * BMP280_RECORD_LENGTH);
+    }
+
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    hwlib::cout << "replayArchive, " << static_cast<uint32_t>(samples) << " samples, " << cores << " cores" << hwlib::endl << "-----" << hwlib::endl;
+
+    std::vector<bmp280_bucket> reference;
+    std::vector<bmp280_bucket> buckets;
+    for (int threads = 1; threads <= (cores > 8 ? cores : 8); threads *= 2) {
+        uint_fast64_t start = hwlib::now_us();
+        replayArchive(archive.data(), archive.size(), 60000000, threads, header, threads == 1 ? reference : buckets);
+        uint_fast64_t replay_us = hwlib::now_us() - start;
+
+        // The result must not depend on the number of threads
+        bool equal = threads == 1 || (buckets.size() == reference.size()
+                     && memcmp(buckets.data(), reference.data(), buckets.size() * sizeof(bmp280_bucket)) == 0);
+        hwlib::cout << "  threads " << threads << ": " << static_cast<uint32_t>(samples / replay_us) << " M samples / s, "
+                    << static_cast<uint32_t>(reference.size()) << " buckets" << (equal ? "" : ", DIFFERENT RESULT") << hwlib::endl;
+    }
+    hwlib::cout << hwlib::endl;
+}
+
+void printTuning(const char* name, const bmp280_tuning_goal& goal) {
+    bmp280_tuning tuning = tuneConfiguration(goal);
+    hwlib::cout << "  " << name << ": ";
+    if (!tuning.feasible) {
+        hwlib::cout << "not feasible" << hwlib::endl;
+        return;
+    }
+    hwlib::cout << (tuning.mode == NORMAL_MODE ? "normal" : "forced") << " x" << oversamplingFactor(tuning.osrs_t)
+                << "/x" << oversamplingFactor(tuning.osrs_p) << " filter ";
+    if (tuning.filter == FILTER_OFF) {
+        hwlib::cout << "off";
+    } else {
+        hwlib::cout << "x" << (1 << tuning.filter);
+    }
+    hwlib::cout << ", " << tuning.period_us << " us period, "
+                << tuning.typical_time_us << " us conversion, " << tuning.noise_mpa << " mPa, "
+                << tuning.response_us / 1000 << " ms response, ";
+    printHundredths(tuning.current_na / 10);
+    hwlib::cout << " uA" << hwlib::endl;
+}
+
+// The settings are computed at compile time
+constexpr bmp280_tuning indoor_navigation = tuneConfiguration(bmp280_tuning_goal{38461, 250, 0});
+static_assert(indoor_navigation.feasible, "indoor navigation must be feasible");
+
+// 0.2 Pa needs the x16 filter, which takes 22 samples of 10 minutes to follow a step, much longer than an hour.
+// That product doesn't fit in 32 bits, it must not wrap around to a response that looks fast enough.
+constexpr bmp280_tuning slow_logger = tuneConfiguration(bmp280_tuning_goal{600000000, 200, 3600000000u});
+static_assert(!slow_logger.feasible, "the response time of a long period must not wrap around");
+
+void benchmarkTuning() {
+    hwlib::cout << "tuneConfiguration" << hwlib::endl << "-----" << hwlib::endl;
+    printTuning("weather, 1 / 60 Hz, 3 Pa", bmp280_tuning_goal{60000000, 3000, 0});
+    printTuning("outfit display, 1 Hz, 1.3 Pa", bmp280_tuning_goal{1000000, 1300, 0});
+    printTuning("elevator, 7 Hz, 0.5 Pa, 1 s response", bmp280_tuning_goal{142857, 500, 1000000});
+    printTuning("indoor navigation, 26 Hz, 0.25 Pa", bmp280_tuning_goal{38461, 250, 0});
+    printTuning("drop detection, 125 Hz, 1.3 Pa, 10 ms response", bmp280_tuning_goal{8000, 1300, 10000});
+    printTuning("handheld, 83 Hz, 0.4 Pa, 100 ms response", bmp280_tuning_goal{12048, 400, 100000});
+    printTuning("too fast, 200 Hz", bmp280_tuning_goal{5000, 3000, 0});
+    printTuning("too quiet, 0.1 Pa", bmp280_tuning_goal{1000000, 100, 0});
+    printTuning("slow logger, 1 / 600 Hz, 0.2 Pa, 1 h response", bmp280_tuning_goal{600000000, 200, 3600000000u});
+
+    // Ultra high resolution, used for everything, costs a lot more
+    hwlib::cout << "  always x2/x16 at 1 Hz instead: ";
+    printHundredths((conversionChargeNc(SAMPLING_X2, SAMPLING_X16) + BMP280_SLEEP_CURRENT_NA) / 10);
+    hwlib::cout << " uA" << hwlib::endl;
+
+    // The simulated sensor runs in normal mode with the period that was promised
+    bmp280_tuning elevator = tuneConfiguration(bmp280_tuning_goal{142857, 500, 1000000});
+    bmp280_sim sim;
+    setupSimulation(sim);
+    bmp280_sim_i2c_bus bus(sim);
+    bmp280 sensor(bus);
+    sensor.configure(elevator);
+    hwlib::cout << "  elevator applied: " << sensor.normalModePeriod() << " us period, "
+                << elevator.period_us << " us expected" << hwlib::endl << hwlib::endl;
+}
+
+// Filters 128 Hz pressure with 1 Pa noise and a 500 Pa glitch every 200 samples down to 1 Hz
+template<typename chain>
+void benchmarkFilterChain(const char* name) {
+    const int32_t pressure = 101325 * 256;
+    const uint32_t samples = 128 * 400;
+
+    chain filter;
+    xorshift random(4);
+    uint32_t outputs = 0;
+    int64_t squares = 0;
+    int32_t worst = 0;
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t n = 0; n < samples; n++) {
+        int32_t input = pressure + random.noise(256);
+        if (n % 200 == 100) {
+            input += (random.next() & 1) ? 500 * 256 : -500 * 256;
+        }
+        int32_t output;
+        if (filter.push(input, output)) {
+            int32_t error = output - pressure;
+            squares += static_cast<int64_t>(error) * error;
+            worst = (error < 0 ? -error : error) > worst ? (error < 0 ? -error : error) : worst;
+            outputs++;
+        }
+    }
+    uint_fast64_t filter_us = hwlib::now_us() - start;
+
+    // The errors are in 1/256 Pa, print them in mPa
+    hwlib::cout << "  " << name << ": " << outputs << " outputs, RMS error "
+                << static_cast<uint32_t>(sqrt(static_cast<double>(squares) / outputs) * 1000 / 256) << " mPa, worst "
+                << static_cast<uint32_t>(static_cast<int64_t>(worst) * 1000 / 256) << " mPa, "
+                << static_cast<uint32_t>(filter_us * 1000 / samples) << " ns / sample" << hwlib::endl;
+}
+
+void benchmarkFilter() {
+    hwlib::cout << "bmp280_filter_chain, 128 Hz to 1 Hz, 1 Pa noise, 500 Pa glitches" << hwlib::endl << "-----" << hwlib::endl;
+    benchmarkFilterChain<bmp280_filter_chain<bmp280_boxcar_decimator<128>>>("boxcar<128>");
+    benchmarkFilterChain<bmp280_filter_chain<bmp280_median_filter<3>, bmp280_boxcar_decimator<128>>>("median<3>, boxcar<128>");
+    benchmarkFilterChain<bmp280_filter_chain<bmp280_median_filter<3>, bmp280_iir_filter<1>, bmp280_cic_decimator<128, 2>>>("median<3>, iir<1>, cic<128, 2>");
+    benchmarkFilterChain<bmp280_filter_chain<bmp280_median_filter<5>, bmp280_cic_decimator<128, 3>>>("median<5>, cic<128, 3>");
+
+    // A constant passes every stage unchanged, also after the CIC integrators wrapped around
+    bmp280_sample_filter<bmp280_filter_chain<bmp280_median_filter<5>, bmp280_iir_filter<4>, bmp280_cic_decimator<64, 4>>> filter;
+    bmp280_sample_int constant = {-1234, 101325 * 256};
+    bmp280_sample_int output = {0, 0};
+    uint32_t mismatches = 0;
+    for (uint32_t n = 0; n < 64 * 1000; n++) {
+        if (filter.push(constant, output)) {
+            mismatches += (output.temperature != constant.temperature || output.pressure != constant.pressure) ? 1 : 0;
+        }
+    }
+    hwlib::cout << "  constant input: " << mismatches << " mismatches" << hwlib::endl << hwlib::endl;
+}
+
+// Busy waits like an I2C transfer or display update of a fixed duration
+class busy_task : public bmp280_task {
+private:
+    uint32_t duration_us;
+
+public:
+    busy_task(uint32_t duration_us):
+        duration_us(duration_us)
+    {}
+
+    void run(uint_fast64_t) override {
+        hwlib::wait_us(duration_us);
+    }
+};
+
+void benchmarkScheduler() {
+    const uint32_t run_us = 2000000;
+    hwlib::cout << "bmp280_scheduler, 1 ms sampling every 10 ms, 7 ms display every 50 ms, 3 ms printing every 100 ms"
+                << hwlib::endl << "-----" << hwlib::endl;
+
+    // The original loop: work, then wait a fixed time, so every period is stretched by the work
+    bmp280_histogram naive_period;
+    uint_fast64_t end = hwlib::now_us() + run_us;
+    uint_fast64_t previous = hwlib::now_us();
+    uint32_t naive_samples = 0;
+    while (hwlib::now_us() < end) {
+        uint_fast64_t start = hwlib::now_us();
+        if (naive_samples > 0) {
+            naive_period.add(static_cast<uint32_t>(start - previous));
+        }
+        previous = start;
+        hwlib::wait_us(1000);
+        if (naive_samples % 5 == 0) {
+            hwlib::wait_us(7000);
+        }
+        if (naive_samples % 10 == 0) {
+            hwlib::wait_us(3000);
+        }
+        naive_samples++;
+        hwlib::wait_us(10000 - 1000);
+    }
+    hwlib::cout << "  wait loop: " << naive_samples << " samples in 2 s, period " << naive_period.getMinimum()
+                << " .. " << naive_period.getMaximum() << " us" << hwlib::endl;
+
+    // The same work against absolute deadlines
+    busy_task sampling(1000);
+    busy_task display(7000);
+    busy_task printing(3000);
+    bmp280_scheduler<3> scheduler;
+    scheduler.add(sampling, "sampling", 10000, PRIORITY_ACQUISITION);
+    scheduler.add(display, "display", 50000, PRIORITY_DISPLAY);
+    scheduler.add(printing, "printing", 100000, PRIORITY_LOGGING);
+    scheduler.start();
+
+    // The first run of every task has no execution time to judge it by yet, so leave it out
+    end = hwlib::now_us() + 100000;
+    while (hwlib::now_us() < end) {
+        scheduler.runNext();
+    }
+    scheduler.resetStats();
+    end = hwlib::now_us() + run_us;
+    while (hwlib::now_us() < end) {
+        scheduler.runNext();
+    }
+    const bmp280_task_stats& stats = scheduler.getStats(0);
+    hwlib::cout << "  scheduler: " << stats.runs << " samples in 2 s, " << stats.missed << " missed, lateness "
+                << stats.lateness.getMinimum() << " .. " << stats.lateness.getMaximum() << " us, jitter at most "
+                << stats.jitter.getMaximum() << " us" << hwlib::endl;
+    for (int i = 1; i < scheduler.getTaskCount(); i++) {
+        const bmp280_task_stats& ui = scheduler.getStats(i);
+        hwlib::cout << "  " << (i == 1 ? "display" : "printing") << ": " << ui.runs << " runs, lateness at most "
+                    << ui.lateness.getMaximum() << " us" << hwlib::endl;
+    }
+    hwlib::cout << hwlib::endl;
+    scheduler.printStats();
+    hwlib::cout << hwlib::endl;
+}
+
+// Statistics of a window found by going over every stored sample, to check bmp280_rolling_window against
+struct window_statistics {
+    uint32_t count;
+    int32_t minimum;
+    int32_t maximum;
+    int32_t mean;
+    uint64_t variance;
+    int32_t trend;
+};
+
+// Rounds like bmp280RoundedDivide(), with 128-bit math so nothing can overflow
+__int128 roundedDivide(__int128 value, __int128 divisor) {
+    return value >= 0 ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+}
+
+window_statistics rescanWindow(const std::vector<uint_fast64_t>& times, const std::vector<int32_t>& values,
+                               uint_fast64_t now_us, uint32_t bucket_us, int bucket_count) {
+    window_statistics result = {0, 0, 0, 0, 0, 0};
+    uint_fast64_t newest = now_us / bucket_us;
+    __int128 sum = 0, squares = 0, positions = 0, position_squares = 0, products = 0;
+    for (size_t i = 0; i < times.size(); i++) {
+        uint_fast64_t bucket = times[i] / bucket_us;
+        if (bucket + bucket_count <= newest) {
+            continue;
+        }
+        __int128 position = static_cast<__int128>(bucket + bucket_count - 1 - newest);
+        result.minimum = result.count == 0 || values[i] < result.minimum ? values[i] : result.minimum;
+        result.maximum = result.count == 0 || values[i] > result.maximum ? values[i] : result.maximum;
+        result.count++;
+        sum += values[i];
+        squares += static_cast<__int128>(values[i]) * values[i];
+        positions += position;
+        position_squares += position * position;
+        products += position * values[i];
+    }
+    if (result.count == 0) {
+        return result;
+    }
+    __int128 n = result.count;
+    result.mean = static_cast<int32_t>(roundedDivide(sum, n));
+    result.variance = static_cast<uint64_t>((n * squares - sum * sum) / (n * n));
+    __int128 spread = n * position_squares - positions * positions;
+    if (spread != 0) {
+        result.trend = static_cast<int32_t>(roundedDivide((n * products - positions * sum) * bucket_count, spread));
+    }
+    return result;
+}
+
+// Feeds a week of the weather trace, with two gaps, and compares every query with a rescan of all samples
+void benchmarkRollingWindow() {
+    const uint32_t samples = 7 * 86400 / 20;
+    const uint32_t bucket_us = 300000000;
+    hwlib::cout << "bmp280_rolling_window<36>, 3 hours of pressure in 5 minute buckets, a sample every 20 s"
+                << hwlib::endl << "-----" << hwlib::endl;
+
+    weather_trace source;
+    std::vector<uint_fast64_t> times;
+    std::vector<int32_t> pressures;
+    for (uint32_t n = 0; n < samples; n++) {
+        bmp280_raw_sample raw = source.sample(n);
+        int32_t t_fine;
+        compensateTemperatureInt(example_calibration, raw.temperature, t_fine);
+        uint_fast64_t time = static_cast<uint_fast64_t>(n) * 20000000;
+
+        // A 40 minute gap empties part of the window, a 4 hour gap all of it
+        time += n >= samples / 3 ? 2400000000ull : 0;
+        time += n >= 2 * samples / 3 ? 14400000000ull : 0;
+        times.push_back(time);
+        pressures.push_back(static_cast<int32_t>(compensatePressureInt(example_calibration, raw.pressure, t_fine)));
+    }
+
+    bmp280_rolling_window<36> window(bucket_us);
+    uint_fast64_t start = hwlib::now_us();
+    volatile int64_t sink;
+    for (uint32_t n = 0; n < samples; n++) {
+        window.add(pressures[n], times[n]);
+        sink = window.getMinimum() + window.getMaximum() + window.getMean() + window.getTrend(36)
+            + static_cast<int64_t>(window.getVariance());
+    }
+    uint_fast64_t window_us = hwlib::now_us() - start;
+    (void)sink;
+
+    // The rescan only keeps the samples of the window, as a history buffer would
+    uint32_t mismatches = 0;
+    uint32_t rescanned = 0;
+    size_t first = 0;
+    window.clear();
+    start = hwlib::now_us();
+    for (uint32_t n = 0; n < samples; n++) {
+        window.add(pressures[n], times[n]);
+        while ((times[first] / bucket_us) + 36 <= times[n] / bucket_us) {
+            first++;
+        }
+        std::vector<uint_fast64_t> kept_times(times.begin() + first, times.begin() + n + 1);
+        std::vector<int32_t> kept_values(pressures.begin() + first, pressures.begin() + n + 1);
+        window_statistics expected = rescanWindow(kept_times, kept_values, times[n], bucket_us, 36);
+        rescanned += expected.count;
+        mismatches += (window.getCount() != expected.count || window.getMinimum() != expected.minimum
+            || window.getMaximum() != expected.maximum || window.getMean() != expected.mean
+            || window.getVariance() != expected.variance || window.getTrend(36) != expected.trend) ? 1 : 0;
+    }
+    uint_fast64_t rescan_us = hwlib::now_us() - start;
+
+    hwlib::cout << "  add() and all queries: " << static_cast<uint32_t>(window_us * 1000 / samples) << " ns / sample" << hwlib::endl;
+    hwlib::cout << "  rescan of the window:  " << static_cast<uint32_t>(rescan_us * 1000 / samples) << " ns / sample, "
+                << rescanned / samples << " samples per rescan" << hwlib::endl;
+    hwlib::cout << "  results that differ from the rescan: " << mismatches << hwlib::endl;
+
+    // A rising pressure of exactly 1 Pa per 5 minutes, 36 Pa per 3 hours, whatever the noise within a bucket
+    window.clear();
+    xorshift random(5);
+    for (uint32_t n = 0; n < 36 * 15; n++) {
+        int32_t noise = (n % 2 == 0 ? 1 : -1) * static_cast<int32_t>(random.next() % 512);
+        int32_t pressure = 101325 * 256 + static_cast<int32_t>(n / 15) * 256;
+        window.add(pressure + noise, static_cast<uint_fast64_t>(n) * 20000000);
+        window.add(pressure - noise, static_cast<uint_fast64_t>(n) * 20000000);
+    }
+    hwlib::cout << "  trend of a 12 Pa / hour rise: " << window.getTrend(36) / 256 << " Pa / 3 hours, range "
+                << (window.getMaximum() - window.getMinimum()) / 256 << " Pa" << hwlib::endl << hwlib::endl;
+}
+
+int main() {
+    benchmarkBusUsage();
+    benchmarkManager();
+    benchmarkCompensation();
+    benchmarkBatch();
+    benchmarkAltitude();
+    benchmarkInstrumentation();
+    benchmarkSampleLogs();
+    benchmarkReporter();
+    benchmarkProtocol();
+    benchmarkReplay();
+    benchmarkTuning();
+    benchmarkFilter();
+    benchmarkScheduler();
+    benchmarkRollingWindow();
+    return 0;
+}
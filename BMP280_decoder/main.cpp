@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "bmp280_defs.hpp"
+#include "bmp280_compensation.hpp"
+#include "bmp280_protocol.hpp"
+
+/**
+*   Decodes a binary stream written by the BMP280 project in BMP280_BINARY_STREAM mode and prints the
+*   compensated samples as CSV. Read the serial port into a file first, or pipe it in:
+*
+*       stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 | ./main > samples.csv
+*       ./main capture.bin > samples.csv
+*
+*   The sample index counts samples since the start of the stream, lost frames leave a gap in it.
+**/
+
+int main(int argc, char** argv) {
+    FILE* input = stdin;
+    if (argc > 1) {
+        input = fopen(argv[1], "rb");
+        if (input == nullptr) {
+            fprintf(stderr, "can't open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    bmp280_frame_decoder decoder;
+    bmp280_calibration_data calibration;
+    bmp280_raw_sample samples[BMP280_FRAME_MAX_RECORDS];
+    bool calibrated = false;
+    uint32_t period_us = 0;
+
+    // The sequence numbers are 16 bits, the index is extended to 32 bits using the difference with the expected one
+    bool started = false;
+    uint16_t expected = 0;
+    uint32_t index = 0;
+    uint32_t decoded = 0;
+    uint32_t lost = 0;
+    uint32_t uncalibrated = 0;
+
+    printf("index,time_s,temperature_c,pressure_pa\n");
+
+    int c;
+    while ((c = getc(input)) != EOF) {
+        if (!decoder.feed(static_cast<uint8_t>(c))) {
+            continue;
+        }
+
+        if (decoder.getType() == BMP280_FRAME_CALIBRATION) {
+            calibrated = decodeCalibrationFrame(decoder.getPayload(), decoder.getPayloadLength(), calibration, period_us);
+            continue;
+        }
+        if (decoder.getType() != BMP280_FRAME_SAMPLES) {
+            continue;
+        }
+
+        uint16_t sequence;
+        int count = decodeSampleFrame(decoder.getPayload(), decoder.getPayloadLength(), sequence, samples);
+        if (count <= 0) {
+            continue;
+        }
+        if (started) {
+            uint16_t gap = static_cast<uint16_t>(sequence - expected);
+            index += gap;
+            lost += gap;
+        }
+        started = true;
+        expected = static_cast<uint16_t>(sequence + count);
+
+        // Without calibration data the raw samples can't be compensated
+        if (!calibrated) {
+            uncalibrated += count;
+            index += count;
+            continue;
+        }
+        for (int i = 0; i < count; i++, index++) {
+            int32_t t_fine;
+            double temperature = compensateTemperature(calibration, samples[i].temperature, t_fine);
+            double pressure = compensatePressure(calibration, samples[i].pressure, t_fine);
+            printf("%u,%.6f,%.2f,%.2f\n", index, index * (period_us / 1000000.0), temperature, pressure);
+        }
+        decoded += count;
+    }
+
+    if (input != stdin) {
+        fclose(input);
+    }
+
+    fprintf(stderr, "%u frames, %u samples, %u lost, %u before the calibration frame, %u CRC errors, %u bytes skipped\n",
+            decoder.frameCount(), decoded, lost, uncalibrated, decoder.crcErrorCount(), decoder.skippedCount());
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "bmp280_defs.hpp"
+#include "bmp280_calibration.hpp"
+#include "bmp280_protocol.hpp"
+#include "bmp280_archive.hpp"
+#include "bmp280_replay.hpp"
+
+/**
+*   Converts captured binary streams into archives, and recomputes archives into statistics per time bucket.
+*
+*       main pack capture.bin device.arc [device_id] [start_us]
+*       main replay [-t threads] [-b bucket_seconds] [-o buckets.bin] device1.arc device2.arc ... > buckets.csv
+*
+*   The archives are memory mapped, so only the pages that are used are read, and the samples of each archive
+*   are divided over the threads. The binary output holds 64 bytes per bucket, in the byte order of the PC:
+*   device ID (4 bytes), sample count (4 bytes), start of the bucket in microseconds (8 bytes), and the minimum,
+*   maximum and mean temperature and pressure as doubles. Buckets without samples are left out.
+**/
+
+static void writeSkipped(FILE* output, uint32_t count) {
+    uint8_t record[BMP280_RECORD_LENGTH];
+    packRawSample(bmp280_raw_sample{BMP280_RAW_SKIPPED, BMP280_RAW_SKIPPED}, record);
+    for (uint32_t i = 0; i < count; i++) {
+        fwrite(record, 1, BMP280_RECORD_LENGTH, output);
+    }
+}
+
+// Decodes a capture of a BMP280_BINARY_STREAM stream, lost samples are stored as skipped measurements
+static int pack(const char* capture_name, const char* archive_name, uint32_t device_id, uint64_t start_us) {
+    FILE* input = fopen(capture_name, "rb");
+    if (input == nullptr) {
+        fprintf(stderr, "can't open %s\n", capture_name);
+        return 1;
+    }
+    FILE* output = fopen(archive_name, "wb");
+    if (output == nullptr) {
+        fprintf(stderr, "can't create %s\n", archive_name);
+        fclose(input);
+        return 1;
+    }
+
+    // The header is written again at the end, when the sample count and calibration data are known
+    bmp280_archive_header header = {device_id, 0, start_us, 0, {{0}}};
+    uint8_t header_data[BMP280_ARCHIVE_HEADER_LENGTH] = {0};
+    fwrite(header_data, 1, BMP280_ARCHIVE_HEADER_LENGTH, output);
+
+    bmp280_frame_decoder decoder;
+    bmp280_raw_sample samples[BMP280_FRAME_MAX_RECORDS];
+    bool calibrated = false;
+    bool started = false;
+    uint16_t expected = 0;
+    uint64_t lost = 0;
+
+    int c;
+    while ((c = getc(input)) != EOF) {
+        if (!decoder.feed(static_cast<uint8_t>(c))) {
+            continue;
+        }
+        if (decoder.getType() == BMP280_FRAME_CALIBRATION) {
+            bmp280_calibration_data calibration;
+            if (decodeCalibrationFrame(decoder.getPayload(), decoder.getPayloadLength(), calibration, header.period_us)) {
+                serializeCalibration(calibration, header.calibration);
+                calibrated = true;
+            }
+            continue;
+        }
+
+        uint16_t sequence;
+        int count = decodeSampleFrame(decoder.getPayload(), decoder.getPayloadLength(), sequence, samples);
+        if (count <= 0) {
+            continue;
+        }
+        if (started && sequence != expected) {
+            uint16_t gap = static_cast<uint16_t>(sequence - expected);
+            writeSkipped(output, gap);
+            header.sample_count += gap;
+            lost += gap;
+        }
+        started = true;
+        expected = static_cast<uint16_t>(sequence + count);
+
+        uint8_t record[BMP280_RECORD_LENGTH];
+        for (int i = 0; i < count; i++) {
+            packRawSample(samples[i], record);
+            fwrite(record, 1, BMP280_RECORD_LENGTH, output);
+        }
+        header.sample_count += count;
+    }
+    fclose(input);
+
+    if (!calibrated) {
+        fprintf(stderr, "%s holds no calibration frame\n", capture_name);
+        fclose(output);
+        remove(archive_name);
+        return 1;
+    }
+    writeArchiveHeader(header, header_data);
+    fseek(output, 0, SEEK_SET);
+    fwrite(header_data, 1, BMP280_ARCHIVE_HEADER_LENGTH, output);
+    fclose(output);
+
+    fprintf(stderr, "%llu samples, %llu lost, %u CRC errors\n", static_cast<unsigned long long>(header.sample_count),
+            static_cast<unsigned long long>(lost), decoder.crcErrorCount());
+    return 0;
+}
+
+static int replay(int argc, char** argv) {
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    threads = threads < 1 ? 1 : threads;
+    uint64_t bucket_us = 60000000;
+    const char* binary_name = nullptr;
+
+    int arg = 0;
+    for (; arg < argc && argv[arg][0] == '-'; arg += 2) {
+        if (arg + 1 >= argc) {
+            fprintf(stderr, "%s needs a value\n", argv[arg]);
+            return 1;
+        }
+        if (strcmp(argv[arg], "-t") == 0) {
+            threads = atoi(argv[arg + 1]);
+        } else if (strcmp(argv[arg], "-b") == 0) {
+            bucket_us = static_cast<uint64_t>(atof(argv[arg + 1]) * 1000000);
+        } else if (strcmp(argv[arg], "-o") == 0) {
+            binary_name = argv[arg + 1];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[arg]);
+            return 1;
+        }
+    }
+
+    FILE* binary = nullptr;
+    if (binary_name != nullptr) {
+        binary = fopen(binary_name, "wb");
+        if (binary == nullptr) {
+            fprintf(stderr, "can't create %s\n", binary_name);
+            return 1;
+        }
+    } else {
+        printf("device,bucket_start_us,count,temperature_min,temperature_max,temperature_mean,pressure_min,pressure_max,pressure_mean\n");
+    }
+
+    uint64_t total_samples = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<bmp280_bucket> buckets;
+    int result = 0;
+    for (; arg < argc; arg++) {
+        int file = open(argv[arg], O_RDONLY);
+        struct stat status;
+        if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0) {
+            fprintf(stderr, "can't read %s\n", argv[arg]);
+            result = 1;
+            if (file >= 0) {
+                close(file);
+            }
+            continue;
+        }
+        size_t size = static_cast<size_t>(status.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (mapping == MAP_FAILED) {
+            fprintf(stderr, "can't map %s\n", argv[arg]);
+            result = 1;
+            continue;
+        }
+
+        // The records are read front to back by each thread
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        bmp280_archive_header header;
+        bool valid = replayArchive(static_cast<const uint8_t*>(mapping), size, bucket_us, threads, header, buckets);
+        munmap(mapping, size);
+        if (!valid) {
+            fprintf(stderr, "%s isn't a valid archive\n", argv[arg]);
+            result = 1;
+            continue;
+        }
+        total_samples += header.sample_count;
+
+        for (const bmp280_bucket& bucket : buckets) {
+            if (bucket.count == 0) {
+                continue;
+            }
+            if (binary != nullptr) {
+                fwrite(&header.device_id, 4, 1, binary);
+                fwrite(&bucket.count, 4, 1, binary);
+                fwrite(&bucket.start_us, 8, 1, binary);
+                const double values[6] = {bucket.temperature_min, bucket.temperature_max, bucket.temperature_mean,
+                                          bucket.pressure_min, bucket.pressure_max, bucket.pressure_mean};
+                fwrite(values, 8, 6, binary);
+            } else {
+                printf("%u,%llu,%u,%.2f,%.2f,%.3f,%.2f,%.2f,%.3f\n", header.device_id,
+                       static_cast<unsigned long long>(bucket.start_us), bucket.count,
+                       bucket.temperature_min, bucket.temperature_max, bucket.temperature_mean,
+                       bucket.pressure_min, bucket.pressure_max, bucket.pressure_mean);
+            }
+        }
+    }
+    if (binary != nullptr) {
+        fclose(binary);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%llu samples with %d threads in %.3f s, %.1f M samples / s\n",
+            static_cast<unsigned long long>(total_samples), threads, seconds, total_samples / seconds / 1e6);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "pack") == 0) {
+        uint32_t device_id = argc > 4 ? static_cast<uint32_t>(strtoul(argv[4], nullptr, 0)) : 0;
+        uint64_t start_us = argc > 5 ? strtoull(argv[5], nullptr, 0) : 0;
+        return pack(argv[2], argv[3], device_id, start_us);
+    }
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        return replay(argc - 2, argv + 2);
+    }
+
+    fprintf(stderr, "usage: %s pack capture.bin device.arc [device_id] [start_us]\n", argv[0]);
+    fprintf(stderr, "       %s replay [-t threads] [-b bucket_seconds] [-o buckets.bin] archive...\n", argv[0]);
+    return 1;
+}
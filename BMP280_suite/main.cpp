@@ -0,0 +1,370 @@
+// Golden vectors and per-call cost of every compensation and read path, build and run with 'make run'
+//
+// On the PC the sensor is simulated, on an Arduino Due ('make run BOARD=due') a real BMP280 on the
+// scl and sda pins is used and the time is measured with the cycle counter. Run 'make sizes' after a
+// build for the code size of every path.
+
+#include "hwlib.hpp"
+#include "bmp280.hpp"
+#include "bmp280_static.hpp"
+#include "bmp280_compensation.hpp"
+#include "bmp280_batch.hpp"
+#include "bmp280_temperature_lut.hpp"
+#include "bmp280_golden.hpp"
+#ifndef BMPTK_TARGET_arduino_due
+#include "bmp280_sim.hpp"
+#endif
+
+// Results are written here, so the compiler can't leave out the calls that are timed
+volatile int32_t sink_int;
+volatile double sink_double;
+
+#ifdef BMPTK_TARGET_arduino_due
+// The DWT cycle counter of the Cortex-M3 counts every clock cycle, at 84 MHz on the Due
+constexpr uint32_t clock_mhz = 84;
+volatile uint32_t& demcr = *reinterpret_cast<volatile uint32_t*>(0xE000EDFC);
+volatile uint32_t& dwt_ctrl = *reinterpret_cast<volatile uint32_t*>(0xE0001000);
+volatile uint32_t& dwt_cyccnt = *reinterpret_cast<volatile uint32_t*>(0xE0001004);
+
+void startCycleCounter() {
+    demcr |= 1u << 24;  // TRCENA, enables the DWT
+    dwt_cyccnt = 0;
+    dwt_ctrl |= 1;      // CYCCNTENA
+}
+#endif
+
+// Forwards to another bus and counts the transactions and bytes, so the bus usage is known on real hardware too
+class counting_i2c_bus : public hwlib::i2c_bus {
+private:
+    hwlib::i2c_bus& bus;
+
+public:
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+
+    counting_i2c_bus(hwlib::i2c_bus& bus):
+        bus(bus)
+    {}
+
+    void write_start() override { transactions++; bus.write_start(); }
+    void write_stop() override { bus.write_stop(); }
+    void write_ack() override { bus.write_ack(); }
+    void write_nack() override { bus.write_nack(); }
+    bool read_ack() override { return bus.read_ack(); }
+    void write_byte(uint8_t x) override { bytes++; bus.write_byte(x); }
+    uint8_t read_byte() override { bytes++; return bus.read_byte(); }
+};
+
+void printHundredths(uint32_t value) {
+    hwlib::cout << value / 100 << "." << hwlib::setw(2) << hwlib::setfill('0') << value % 100;
+}
+
+// Calls a path a number of times and prints its latency and bus usage per call
+template<typename path>
+void measure(const char* name, uint32_t calls, counting_i2c_bus& bus, path call) {
+    bus.transactions = 0;
+    bus.bytes = 0;
+
+#ifdef BMPTK_TARGET_arduino_due
+    uint32_t start = dwt_cyccnt;
+    for (uint32_t i = 0; i < calls; i++) {
+        call();
+    }
+    uint32_t cycles = (dwt_cyccnt - start) / calls;
+    uint32_t ns = cycles * 1000 / clock_mhz;
+#else
+    uint_fast64_t start = hwlib::now_us();
+    for (uint32_t i = 0; i < calls; i++) {
+        call();
+    }
+    uint32_t ns = static_cast<uint32_t>((hwlib::now_us() - start) * 1000 / calls);
+#endif
+
+    int length = 0;
+    while (name[length] != '\0') {
+        length++;
+    }
+    hwlib::cout << "  " << name << ":";
+    for (int i = length; i < 34; i++) {
+        hwlib::cout << ' ';
+    }
+    hwlib::cout << hwlib::setw(9) << ns << " ns";
+#ifdef BMPTK_TARGET_arduino_due
+    hwlib::cout << hwlib::setw(9) << cycles << " cycles";
+#endif
+    hwlib::cout << hwlib::setw(4) << bus.transactions / calls << " transactions" << hwlib::setw(4) << bus.bytes / calls
+                << " bytes" << hwlib::endl;
+}
+
+// Checks the paths that aren't in checkGoldenVectors() against the expected doubles
+uint32_t checkBatchAndLut() {
+    uint32_t mismatches = 0;
+    for (int c = 0; c < BMP280_GOLDEN_CALIBRATION_COUNT; c++) {
+        const bmp280_calibration_data& calibration = BMP280_GOLDEN_CALIBRATIONS[c];
+        bmp280_temperature_lut<64> lut(calibration);
+        for (const bmp280_golden_vector& vector : BMP280_GOLDEN_VECTORS) {
+            if (vector.calibration != c) {
+                continue;
+            }
+            double temperature;
+            double pressure;
+            compensateBatch(calibration, &vector.raw_temp, &vector.raw_press, 1, &temperature, &pressure);
+            double temperature_error = temperature - vector.temperature_double;
+            double pressure_error = pressure - vector.pressure_double;
+            mismatches += (temperature_error > BMP280_GOLDEN_TEMPERATURE_TOLERANCE || temperature_error < -BMP280_GOLDEN_TEMPERATURE_TOLERANCE
+                           || pressure_error > BMP280_GOLDEN_PRESSURE_TOLERANCE || pressure_error < -BMP280_GOLDEN_PRESSURE_TOLERANCE) ? 1 : 0;
+
+            int32_t t_fine;
+            double lut_error = lut.compensate(vector.raw_temp, t_fine) - vector.temperature_double;
+            double lut_tolerance = lut.maxError() + 0.001;
+            mismatches += (lut_error > lut_tolerance || lut_error < -lut_tolerance) ? 1 : 0;
+        }
+    }
+    return mismatches;
+}
+
+#ifndef BMPTK_TARGET_arduino_due
+// A simulated BME280 that converts the raw temperature and humidity of a golden vector
+void setupHumidityVector(bmp280_sim& sim, const bme280_golden_humidity_vector& vector) {
+    sim.enableHumidity(BME280_GOLDEN_HUMIDITY_CALIBRATION);
+    sim.setTemperatureWaveform(bmp280_sim_waveform{vector.raw_temp, 0, 0, 0});
+    sim.setHumidityWaveform(bmp280_sim_waveform{vector.raw_hum, 0, 0, 0});
+}
+
+// Waits for the first conversion in normal mode and reads it
+bme280_sample_int readNormalMode(bmp280& sensor) {
+    hwlib::wait_us(sensor.normalModePeriod());
+    return sensor.readHumiditySampleInt();
+}
+
+// Runs a BME280 in normal mode with a standby setting that is much shorter than on a BMP280, and checks the
+// period the driver expects, the humidity and the number of conversions in 5 periods
+template<standby_config standby>
+uint32_t checkBme280Standby(uint32_t standby_us) {
+    const bme280_golden_humidity_vector& vector = BME280_GOLDEN_HUMIDITY_VECTORS[0];
+    bmp280_sim sim(BMP280_GOLDEN_CALIBRATIONS[0]);
+    setupHumidityVector(sim, vector);
+    bmp280_sim_i2c_bus bus(sim);
+    bmp280_static<SAMPLING_X16, SAMPLING_X1, FILTER_OFF, standby, NORMAL_MODE> sensor(bus);
+    sensor.setup();
+
+    uint32_t mismatches = sensor.normalModePeriod() != sensor.measurementTime() + standby_us ? 1 : 0;
+    uint32_t conversions = sim.conversions();
+    mismatches += readNormalMode(sensor).humidity != vector.humidity ? 1 : 0;
+    hwlib::wait_us(4 * sensor.normalModePeriod());
+    sensor.readHumiditySampleInt();
+    mismatches += sim.conversions() - conversions < 5 ? 1 : 0;
+    return mismatches;
+}
+
+// Puts every golden vector in the registers of a simulated sensor and reads it back through the driver,
+// which covers loadCalibration(), the register reads and the compensation together
+uint32_t checkSimulatedReads() {
+    uint32_t mismatches = 0;
+    for (const bmp280_golden_vector& vector : BMP280_GOLDEN_VECTORS) {
+        bmp280_sim sim(BMP280_GOLDEN_CALIBRATIONS[vector.calibration]);
+        sim.setTemperatureWaveform(bmp280_sim_waveform{vector.raw_temp, 0, 0, 0});
+        sim.setPressureWaveform(bmp280_sim_waveform{vector.raw_press, 0, 0, 0});
+        bmp280_sim_i2c_bus bus(sim);
+        bmp280 sensor(bus);
+
+        // x16 keeps all 20 bits of the raw values
+        sensor.setOversampling(SAMPLING_X16, SAMPLING_X16);
+        sensor.startMeasurement();
+        hwlib::wait_us(sensor.remainingMeasurementTime());
+        while (!sensor.poll()) {}
+        bmp280_sample_int sample = sensor.collectInt();
+        mismatches += (sample.temperature != vector.temperature || sample.pressure != vector.pressure) ? 1 : 0;
+    }
+
+    // The same for the humidity of a BME280, which also covers the detection and the humidity calibration
+    for (const bme280_golden_humidity_vector& vector : BME280_GOLDEN_HUMIDITY_VECTORS) {
+        bmp280_sim sim(BMP280_GOLDEN_CALIBRATIONS[0]);
+        setupHumidityVector(sim, vector);
+        bmp280_sim_i2c_bus bus(sim);
+        bmp280 sensor(bus);
+
+        sensor.setOversampling(SAMPLING_X16, SAMPLING_X1);
+        sensor.startMeasurement();
+        hwlib::wait_us(sensor.remainingMeasurementTime());
+        while (!sensor.poll()) {}
+        bme280_sample_int sample = sensor.collectHumiditySampleInt();
+        mismatches += sample.humidity != vector.humidity ? 1 : 0;
+    }
+
+    // In normal mode the first write is the configuration itself, ctrl_hum must be set before it
+    for (const bme280_golden_humidity_vector& vector : BME280_GOLDEN_HUMIDITY_VECTORS) {
+        bmp280_sim static_sim(BMP280_GOLDEN_CALIBRATIONS[0]);
+        setupHumidityVector(static_sim, vector);
+        bmp280_sim_i2c_bus static_bus(static_sim);
+        bmp280_static<SAMPLING_X16, SAMPLING_X1, FILTER_OFF, STANDBY_MS_1, NORMAL_MODE> static_sensor(static_bus);
+        static_sensor.setup();
+        mismatches += readNormalMode(static_sensor).humidity != vector.humidity ? 1 : 0;
+
+        bmp280_sim tuned_sim(BMP280_GOLDEN_CALIBRATIONS[0]);
+        setupHumidityVector(tuned_sim, vector);
+        bmp280_sim_i2c_bus tuned_bus(tuned_sim);
+        bmp280 tuned_sensor(tuned_bus);
+        bmp280_tuning tuning = {};
+        tuning.feasible = true;
+        tuning.mode = NORMAL_MODE;
+        tuning.osrs_t = SAMPLING_X16;
+        tuning.osrs_p = SAMPLING_X1;
+        tuning.filter = FILTER_OFF;
+        tuning.standby = STANDBY_MS_1;
+        tuned_sensor.configure(tuning);
+        mismatches += readNormalMode(tuned_sensor).humidity != vector.humidity ? 1 : 0;
+    }
+
+    // The two longest standby settings are 10 ms and 20 ms on a BME280 instead of 2 s and 4 s
+    mismatches += checkBme280Standby<STANDBY_MS_2000>(10000);
+    mismatches += checkBme280Standby<STANDBY_MS_4000>(20000);
+    return mismatches;
+}
+#endif
+
+void printGoldenVectors() {
+    hwlib::cout << "Golden vectors, " << BMP280_GOLDEN_VECTOR_COUNT << " readings of " << BMP280_GOLDEN_CALIBRATION_COUNT
+                << " calibration sets" << hwlib::endl << "-----" << hwlib::endl;
+    bmp280_golden_result result = checkGoldenVectors();
+    hwlib::cout << "  compensateTemperatureInt():        " << result.temperature_int << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensatePressureInt():           " << result.pressure_int << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensateTemperature():           " << result.temperature_double << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensatePressure():              " << result.pressure_double << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensateTemperature(plan):       " << result.temperature_plan << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensatePressure(plan):          " << result.pressure_plan << " mismatches" << hwlib::endl;
+    hwlib::cout << "  compensateHumidityInt():           " << result.humidity_int << " mismatches" << hwlib::endl;
+    uint32_t mismatches = goldenMismatches(result);
+
+    uint32_t batch_and_lut = checkBatchAndLut();
+    hwlib::cout << "  compensateBatch() and LUT:         " << batch_and_lut << " mismatches" << hwlib::endl;
+    mismatches += batch_and_lut;
+
+#ifndef BMPTK_TARGET_arduino_due
+    uint32_t reads = checkSimulatedReads();
+    hwlib::cout << "  collectInt() on a simulated bus:   " << reads << " mismatches" << hwlib::endl;
+    mismatches += reads;
+#endif
+
+    hwlib::cout << (mismatches == 0 ? "  PASS" : "  FAIL") << hwlib::endl << hwlib::endl;
+}
+
+void printCompensationCost(counting_i2c_bus& bus) {
+#ifdef BMPTK_TARGET_arduino_due
+    const uint32_t calls = 1000;
+#else
+    // now_us() only counts microseconds
+    const uint32_t calls = 100000;
+#endif
+    const bmp280_golden_vector& vector = BMP280_GOLDEN_VECTORS[0];
+    const bmp280_calibration_data& calibration = BMP280_GOLDEN_CALIBRATIONS[0];
+    bmp280_compensation_plan plan;
+    buildCompensationPlan(calibration, plan);
+    bmp280_temperature_lut<64> lut(calibration);
+
+    // The raw value changes every call, so nothing can be computed once for all calls
+    uint32_t raw_temp = vector.raw_temp;
+    uint32_t raw_press = vector.raw_press;
+    int32_t t_fine = vector.t_fine;
+
+    hwlib::cout << "Compensation, per call" << hwlib::endl << "-----" << hwlib::endl;
+    measure("compensateTemperatureInt()", calls, bus, [&]() {
+        sink_int = compensateTemperatureInt(calibration, raw_temp++ & 0xFFFFF, t_fine);
+    });
+    measure("compensatePressureInt()", calls, bus, [&]() {
+        sink_int = static_cast<int32_t>(compensatePressureInt(calibration, raw_press++ & 0xFFFFF, vector.t_fine));
+    });
+    measure("compensateTemperature()", calls, bus, [&]() {
+        sink_double = compensateTemperature(calibration, raw_temp++ & 0xFFFFF, t_fine);
+    });
+    measure("compensatePressure()", calls, bus, [&]() {
+        sink_double = compensatePressure(calibration, raw_press++ & 0xFFFFF, vector.t_fine);
+    });
+    measure("compensateTemperature(plan)", calls, bus, [&]() {
+        sink_double = compensateTemperature(plan, raw_temp++ & 0xFFFFF, t_fine);
+    });
+    measure("compensatePressure(plan)", calls, bus, [&]() {
+        sink_double = compensatePressure(plan, raw_press++ & 0xFFFFF, vector.t_fine);
+    });
+    measure("bmp280_temperature_lut<64>", calls, bus, [&]() {
+        sink_double = lut.compensate(raw_temp++ & 0xFFFFF, t_fine);
+    });
+    measure("compensateBatch(), 1 sample", calls, bus, [&]() {
+        double temperature;
+        double pressure;
+        uint32_t raw = raw_temp++ & 0xFFFFF;
+        compensateBatch(calibration, &raw, &vector.raw_press, 1, &temperature, &pressure);
+        sink_double = temperature + pressure;
+    });
+    hwlib::cout << hwlib::endl;
+}
+
+void printReadCost(counting_i2c_bus& bus) {
+    const uint32_t calls = 50;
+    bmp280 sensor(bus);
+    sensor.setOversampling(SAMPLING_X1, SAMPLING_X1);
+
+    hwlib::cout << "Bus paths, per call" << hwlib::endl << "-----" << hwlib::endl;
+    measure("loadCalibration()", calls, bus, [&]() {
+        // The constructor doesn't use the bus, the calibration data is read on first use
+        bmp280 fresh(bus);
+        sink_int = fresh.getCalibrationData().dig_T1;
+    });
+    measure("readStatus(), read8()", calls, bus, [&]() {
+        sink_int = sensor.readStatus();
+    });
+    measure("getTemperatureInt(), read20u()", calls, bus, [&]() {
+        sink_int = sensor.getTemperatureInt();
+    });
+    measure("getPressureInt()", calls, bus, [&]() {
+        sink_int = static_cast<int32_t>(sensor.getPressureInt());
+    });
+    measure("getTemperature()", calls, bus, [&]() {
+        sink_double = sensor.getTemperature();
+    });
+    measure("getPressure()", calls, bus, [&]() {
+        sink_double = sensor.getPressure();
+    });
+    measure("readSampleRaw()", calls, bus, [&]() {
+        sink_int = static_cast<int32_t>(sensor.readSampleRaw().temperature);
+    });
+    measure("readSampleInt()", calls, bus, [&]() {
+        sink_int = sensor.readSampleInt().temperature;
+    });
+    measure("readSample()", calls, bus, [&]() {
+        sink_double = sensor.readSample().temperature;
+    });
+    measure("readHumiditySampleInt()", calls, bus, [&]() {
+        sink_int = static_cast<int32_t>(sensor.readHumiditySampleInt().humidity);
+    });
+    measure("snapshot()", calls, bus, [&]() {
+        sink_int = sensor.snapshot().registers[0];
+    });
+    hwlib::cout << hwlib::endl;
+}
+
+int main() {
+#ifdef BMPTK_TARGET_arduino_due
+    namespace target = hwlib::target;
+    auto scl = target::pin_oc(target::pins::scl);
+    auto sda = target::pin_oc(target::pins::sda);
+    auto i2c_bus = hwlib::i2c_bus_bit_banged_scl_sda(scl, sda);
+    startCycleCounter();
+
+    // Give the terminal time to connect
+    hwlib::wait_ms(1000);
+#else
+    // A BME280, so the humidity path is measured as well
+    bmp280_sim sim;
+    sim.enableHumidity();
+    sim.setTemperatureWaveform(bmp280_sim_waveform{519888, 3000, 10000000, 20});
+    sim.setPressureWaveform(bmp280_sim_waveform{415148, 2000, 60000000, 20});
+    bmp280_sim_i2c_bus i2c_bus(sim);
+#endif
+    counting_i2c_bus bus(i2c_bus);
+
+    printGoldenVectors();
+    printCompensationCost(bus);
+    printReadCost(bus);
+    return 0;
+}